@@ -1,3 +1,11 @@
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.vert -o shaders\simple_shader.vert.spv
 C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.frag -o shaders\simple_shader.frag.spv
+REM the simple_shader variants init::createPipelines builds, named after their defines
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.vert -DTEXTURED -o shaders\simple_shader.vert.TEXTURED.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.vert -DTEXTURED -DVERTEX_COLOR -o shaders\simple_shader.vert.TEXTURED.VERTEX_COLOR.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.frag -DTEXTURED -o shaders\simple_shader.frag.TEXTURED.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.frag -DALPHA_BLEND -o shaders\simple_shader.frag.ALPHA_BLEND.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\simple_shader.frag -DTEXTURED -DALPHA_BLEND -o shaders\simple_shader.frag.TEXTURED.ALPHA_BLEND.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\bindless_shader.vert -o shaders\bindless_shader.vert.spv
+C:\VulkanSDK\1.3.268.0\Bin\glslc.exe shaders\bindless_shader.frag -o shaders\bindless_shader.frag.spv
 pause
\ No newline at end of file
@@ -1,3 +1,12 @@
+set -e
 glslc shaders/simple_shader.vert -o shaders/simple_shader.vert.spv
 glslc shaders/simple_shader.frag -o shaders/simple_shader.frag.spv
+# the simple_shader variants init::createPipelines builds, named after their defines
+glslc shaders/simple_shader.vert -DTEXTURED -o shaders/simple_shader.vert.TEXTURED.spv
+glslc shaders/simple_shader.vert -DTEXTURED -DVERTEX_COLOR -o shaders/simple_shader.vert.TEXTURED.VERTEX_COLOR.spv
+glslc shaders/simple_shader.frag -DTEXTURED -o shaders/simple_shader.frag.TEXTURED.spv
+glslc shaders/simple_shader.frag -DALPHA_BLEND -o shaders/simple_shader.frag.ALPHA_BLEND.spv
+glslc shaders/simple_shader.frag -DTEXTURED -DALPHA_BLEND -o shaders/simple_shader.frag.TEXTURED.ALPHA_BLEND.spv
 glslc shaders/compute.comp -o shaders/compute.comp.spv
+glslc shaders/bindless_shader.vert -o shaders/bindless_shader.vert.spv
+glslc shaders/bindless_shader.frag -o shaders/bindless_shader.frag.spv
@@ -0,0 +1,37 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// matches BindlessSet::FEEDBACK_LOD_BIAS
+const float LOD_BIAS = 16.0;
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+layout(set = 0, binding = 1) uniform sampler2D textures[];
+
+// finest mip level requested per texture, relative to the resident base level
+layout(set = 0, binding = 2) buffer Feedback {
+	uint requestedLod[];
+} feedback;
+
+layout(push_constant) uniform constants
+{
+	mat4 transform;
+	vec4 color;
+	vec4 uvTransform;
+	uint textureIndex;
+} PushConstants;
+
+void main() {
+	// the index is uniform across a draw, so no nonuniformEXT is needed
+	outColor = texture(textures[PushConstants.textureIndex], fragTexCoord) * fragColor;
+
+	// queried in uniform control flow, the implicit derivatives are undefined inside the branch
+	float lod = textureQueryLod(textures[PushConstants.textureIndex], fragTexCoord).y;
+	// one fragment in an 8x8 tile is enough to find the finest level a texture needs
+	if ((uint(gl_FragCoord.x) & 7u) == 0u && (uint(gl_FragCoord.y) & 7u) == 0u) {
+		atomicMin(feedback.requestedLod[PushConstants.textureIndex], uint(max(floor(lod) + LOD_BIAS, 0.0)));
+	}
+}
@@ -0,0 +1,27 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform SceneUniformBufferObject {
+	mat4 view;
+	mat4 proj;
+} scene;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+layout(location = 2) in vec2 inTexCoord;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+
+layout(push_constant) uniform constants
+{
+	mat4 transform;
+	vec4 color;
+	vec4 uvTransform;
+	uint textureIndex;
+} PushConstants;
+
+void main() {
+	gl_Position = scene.proj * scene.view * PushConstants.transform * vec4(inPosition, 1.0);
+	fragColor = vec4(inColor * PushConstants.color.rgb, PushConstants.color.a);
+	fragTexCoord = inTexCoord * PushConstants.uvTransform.xy + PushConstants.uvTransform.zw;
+}
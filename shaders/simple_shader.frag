@@ -1,11 +1,23 @@
 #version 450
+// features: TEXTURED ALPHA_BLEND
 layout(location = 0) in vec4 fragColor;
+#ifdef TEXTURED
 layout(location = 1) in vec2 fragTexCoord;
+#endif
 
 layout(location = 0) out vec4 outColor;
 
+#ifdef TEXTURED
 layout(binding = 1) uniform sampler2D texSampler;
+#endif
 
 void main() {
-	outColor = texture(texSampler, fragTexCoord) * fragColor;	
+#ifdef TEXTURED
+	outColor = texture(texSampler, fragTexCoord) * fragColor;
+#else
+	outColor = fragColor;
+#endif
+#ifndef ALPHA_BLEND
+	outColor.a = 1.0;
+#endif
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #version 450
+// features: TEXTURED VERTEX_COLOR
 
 layout(binding = 0) uniform UniformBufferObject {
 	mat4 model;
@@ -11,16 +12,25 @@ layout(location = 1) in vec3 inColor;
 layout(location = 2) in vec2 inTexCoord;
 
 layout(location = 0) out vec4 fragColor;
+#ifdef TEXTURED
 layout(location = 1) out vec2 fragTexCoord;
+#endif
 
 layout(push_constant) uniform constants
 {
 	mat4 transform;
 	vec4 color;
+	vec4 uvTransform;
 } PushConstants;
 
 void main() {
 	gl_Position = ubo.proj * ubo.view * ubo.model * vec4(inPosition, 1.0);
+#ifdef VERTEX_COLOR
 	fragColor = vec4(inColor * PushConstants.color.rgb, PushConstants.color.a);
-	fragTexCoord = inTexCoord;
+#else
+	fragColor = PushConstants.color;
+#endif
+#ifdef TEXTURED
+	fragTexCoord = inTexCoord * PushConstants.uvTransform.xy + PushConstants.uvTransform.zw;
+#endif
 }
\ No newline at end of file
@@ -0,0 +1,219 @@
+#include "asset_cache.hpp"
+#include "utility/images.hpp"
+#include "utility/texture_loader.hpp"
+
+// std
+#include <fstream>
+#include <stdexcept>
+
+namespace lve {
+AssetCache::AssetCache(LveDevice &device, util::ThreadPool &threadPool, VkDeviceSize budget)
+    : device{device}, threadPool{threadPool}, budget{budget} {}
+
+AssetCache::~AssetCache() {
+    for (auto &[key, entry] : textures) {
+        destroyEntry(entry);
+    }
+    for (auto &[key, entry] : meshes) {
+        destroyEntry(entry);
+    }
+    for (auto &[key, entry] : atlases) {
+        destroyEntry(entry);
+    }
+}
+
+std::shared_ptr<AllocatedImage> AssetCache::acquireTexture(const std::string &path) { return acquireTextures({path})[0]; }
+
+std::vector<std::shared_ptr<AllocatedImage>> AssetCache::acquireTextures(const std::vector<std::string> &paths) {
+    std::vector<uint64_t> keys;
+    std::vector<uint64_t> missingKeys;
+    std::vector<util::TextureRequest> requests;
+    for (const std::string &path : paths) {
+        uint64_t key = textureKey(path, 0);
+        keys.push_back(key);
+        if (textures.find(key) == textures.end()) {
+            Entry &entry = textures[key];
+            entry.texture = std::make_unique<AllocatedImage>();
+            requests.push_back({path, entry.texture.get()});
+            missingKeys.push_back(key);
+        }
+    }
+
+    if (!requests.empty()) {
+        try {
+            util::TextureLoader textureLoader{device, threadPool};
+            textureLoader.loadTextureImages(requests);
+        } catch (...) {
+            // the requests that succeeded were uploaded before the batch failed
+            for (uint64_t key : missingKeys) {
+                Entry &entry = textures[key];
+                if (entry.texture->image != VK_NULL_HANDLE) {
+                    destroyEntry(entry);
+                }
+                textures.erase(key);
+            }
+            throw;
+        }
+
+        for (uint64_t key : missingKeys) {
+            Entry &entry = textures[key];
+            VkMemoryRequirements memRequirements;
+            vkGetImageMemoryRequirements(device.device(), entry.texture->image, &memRequirements);
+            entry.size = memRequirements.size;
+            residentBytes += entry.size;
+        }
+    }
+
+    std::vector<std::shared_ptr<AllocatedImage>> handles;
+    for (uint64_t key : keys) {
+        handles.push_back(makeHandle(textures, key, textures[key].texture.get()));
+    }
+    evict();
+    return handles;
+}
+
+std::shared_ptr<AllocatedImage> AssetCache::acquireTextureLevels(const std::string &path, uint32_t firstLevel) {
+    uint64_t key = textureKey(path, firstLevel);
+    if (textures.find(key) == textures.end()) {
+        auto texture = std::make_unique<AllocatedImage>();
+        util::StagedTexture staged = util::loadStagedTexture(&device, util::readTextureInfo(&device, path), firstLevel);
+        util::uploadStagedTexture(&device, staged, *texture);
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(device.device(), texture->image, &memRequirements);
+        Entry &entry = textures[key];
+        entry.size = memRequirements.size;
+        entry.texture = std::move(texture);
+        residentBytes += entry.size;
+    }
+
+    std::shared_ptr<AllocatedImage> handle = makeHandle(textures, key, textures[key].texture.get());
+    evict();
+    return handle;
+}
+
+std::shared_ptr<Mesh> AssetCache::acquireMesh(const std::string &path) {
+    uint64_t key = contentHash(path);
+    if (meshes.find(key) == meshes.end()) {
+        auto mesh = std::make_unique<Mesh>(device, path);
+        Entry &entry = meshes[key];
+        entry.size = mesh->getSize();
+        entry.mesh = std::move(mesh);
+        residentBytes += entry.size;
+    }
+
+    std::shared_ptr<Mesh> handle = makeHandle(meshes, key, meshes[key].mesh.get());
+    evict();
+    return handle;
+}
+
+std::shared_ptr<TextureAtlas> AssetCache::acquireAtlas(const std::vector<std::string> &paths) {
+    // FNV-1a over the files' hashes
+    uint64_t key = 14695981039346656037ull;
+    for (const std::string &path : paths) {
+        key = (key ^ contentHash(path)) * 1099511628211ull;
+    }
+    if (atlases.find(key) == atlases.end()) {
+        auto atlas = std::make_unique<TextureAtlas>(device, threadPool, paths);
+        Entry &entry = atlases[key];
+        entry.size = atlas->getSize();
+        entry.atlas = std::move(atlas);
+        residentBytes += entry.size;
+    }
+
+    std::shared_ptr<TextureAtlas> handle = makeHandle(atlases, key, atlases[key].atlas.get());
+    evict();
+    return handle;
+}
+
+void AssetCache::setBudget(VkDeviceSize newBudget) {
+    budget = newBudget;
+    evict();
+}
+
+uint64_t AssetCache::textureKey(const std::string &path, uint32_t firstLevel) {
+    uint64_t key = contentHash(path);
+    // the whole texture keeps the file's hash, so acquireTexture finds it too
+    if (firstLevel > 0) {
+        key = (key ^ firstLevel) * 1099511628211ull;
+    }
+    return key;
+}
+
+uint64_t AssetCache::contentHash(const std::string &path) {
+    std::error_code error;
+    std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(path, error);
+    auto record = pathHashes.find(path);
+    if (!error && record != pathHashes.end() && record->second.writeTime == writeTime) {
+        return record->second.hash;
+    }
+
+    std::ifstream file{path, std::ios::binary};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + path);
+    }
+
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ull;
+    char buffer[64 * 1024];
+    while (file) {
+        file.read(buffer, sizeof(buffer));
+        for (std::streamsize i = 0; i < file.gcount(); i++) {
+            hash ^= static_cast<uint8_t>(buffer[i]);
+            hash *= 1099511628211ull;
+        }
+    }
+
+    pathHashes[path] = {writeTime, hash};
+    return hash;
+}
+
+template <typename T> std::shared_ptr<T> AssetCache::makeHandle(EntryMap &entries, uint64_t key, T *resource) {
+    Entry &entry = entries.at(key);
+    entry.refCount++;
+    entry.lastUsed = ++useCounter;
+    return std::shared_ptr<T>(resource, [this, &entries, key](T *) { release(entries, key); });
+}
+
+void AssetCache::release(EntryMap &entries, uint64_t key) {
+    Entry &entry = entries.at(key);
+    entry.refCount--;
+    entry.lastUsed = ++useCounter;
+    if (entry.refCount == 0) {
+        evict();
+    }
+}
+
+void AssetCache::destroyEntry(Entry &entry) {
+    if (entry.texture) {
+        destroyImage(device.device(), *entry.texture);
+        entry.texture.reset();
+    }
+    entry.mesh.reset();
+    // pages models still reference are destroyed once they let go of them
+    entry.atlas.reset();
+    residentBytes -= entry.size;
+    entry.size = 0;
+}
+
+void AssetCache::evict() {
+    while (residentBytes > budget) {
+        EntryMap *oldestMap = nullptr;
+        EntryMap::iterator oldest;
+        for (EntryMap *entries : {&textures, &meshes, &atlases}) {
+            for (auto it = entries->begin(); it != entries->end(); it++) {
+                if (it->second.refCount == 0 && (!oldestMap || it->second.lastUsed < oldest->second.lastUsed)) {
+                    oldestMap = entries;
+                    oldest = it;
+                }
+            }
+        }
+
+        // everything left is still referenced by a scene
+        if (!oldestMap) {
+            return;
+        }
+        destroyEntry(oldest->second);
+        oldestMap->erase(oldest);
+    }
+}
+} // namespace lve
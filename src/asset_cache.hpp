@@ -0,0 +1,79 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_types.hpp"
+#include "mesh.hpp"
+#include "texture_atlas.hpp"
+#include "utility/thread_pool.hpp"
+
+// std
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Textures, meshes and texture atlases shared between scenes. Assets are keyed by the hash of their
+// source files, so the same content loaded through any path maps to one GPU resource. Handles are reference
+// counted; unreferenced assets stay resident until the cache exceeds its budget and are then
+// evicted least recently used first.
+class AssetCache {
+public:
+    static constexpr VkDeviceSize DEFAULT_BUDGET = 512 * 1024 * 1024;
+
+    AssetCache(LveDevice &device, util::ThreadPool &threadPool, VkDeviceSize budget = DEFAULT_BUDGET);
+    ~AssetCache();
+
+    AssetCache(const AssetCache &) = delete;
+    AssetCache &operator=(const AssetCache &) = delete;
+
+    std::shared_ptr<AllocatedImage> acquireTexture(const std::string &path);
+    // misses are decoded in parallel through util::TextureLoader
+    std::vector<std::shared_ptr<AllocatedImage>> acquireTextures(const std::vector<std::string> &paths);
+    // only the levels from firstLevel down, e.g. the mip tail a TextureStreamer keeps resident
+    std::shared_ptr<AllocatedImage> acquireTextureLevels(const std::string &path, uint32_t firstLevel);
+    std::shared_ptr<Mesh> acquireMesh(const std::string &path);
+    // the same files in the same order map to one atlas
+    std::shared_ptr<TextureAtlas> acquireAtlas(const std::vector<std::string> &paths);
+
+    void setBudget(VkDeviceSize newBudget);
+    VkDeviceSize getBudget() { return budget; }
+    VkDeviceSize getResidentBytes() { return residentBytes; }
+
+private:
+    struct Entry {
+        std::unique_ptr<AllocatedImage> texture;
+        std::unique_ptr<Mesh> mesh;
+        std::unique_ptr<TextureAtlas> atlas;
+        VkDeviceSize size = 0;
+        uint32_t refCount = 0;
+        uint64_t lastUsed = 0;
+    };
+    using EntryMap = std::unordered_map<uint64_t, Entry>;
+
+    struct PathRecord {
+        std::filesystem::file_time_type writeTime;
+        uint64_t hash;
+    };
+
+    uint64_t contentHash(const std::string &path);
+    uint64_t textureKey(const std::string &path, uint32_t firstLevel);
+    template <typename T> std::shared_ptr<T> makeHandle(EntryMap &entries, uint64_t key, T *resource);
+    void release(EntryMap &entries, uint64_t key);
+    void destroyEntry(Entry &entry);
+    void evict();
+
+    LveDevice &device;
+    util::ThreadPool &threadPool;
+    VkDeviceSize budget;
+    VkDeviceSize residentBytes = 0;
+    uint64_t useCounter = 0;
+
+    std::unordered_map<std::string, PathRecord> pathHashes;
+    EntryMap textures;
+    EntryMap meshes;
+    EntryMap atlases;
+};
+} // namespace lve
@@ -0,0 +1,159 @@
+#include "bindless_set.hpp"
+
+// std
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+namespace lve {
+const std::vector<DescriptorTemplateEntry> &BindlessSet::FrameDescriptors::templateEntries() {
+    static const std::vector<DescriptorTemplateEntry> entries = {
+        DescriptorTemplateEntry::buffer(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, offsetof(FrameDescriptors, uniformBuffer)),
+        DescriptorTemplateEntry::buffer(2, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, offsetof(FrameDescriptors, feedback))};
+    return entries;
+}
+
+BindlessSet::BindlessSet(LveDevice &device, VkDescriptorSetLayout layout)
+    : lveDevice{device}, textureCapacity{device.getMaxBindlessTextures()}, pendingTextures(device.getFramesInFlight()) {
+    createUniformBuffers();
+    createFeedbackBuffers();
+    createDescriptorSets(layout);
+}
+
+BindlessSet::~BindlessSet() {
+    descriptorAllocator.destroyDescriptorPools();
+    for (size_t i = 0; i < uniformBuffers.size(); i++) {
+        vkDestroyBuffer(lveDevice.device(), uniformBuffers[i], nullptr);
+        vkFreeMemory(lveDevice.device(), uniformBuffersMemory[i], nullptr);
+    }
+    for (size_t i = 0; i < feedbackBuffers.size(); i++) {
+        vkDestroyBuffer(lveDevice.device(), feedbackBuffers[i], nullptr);
+        vkFreeMemory(lveDevice.device(), feedbackBuffersMemory[i], nullptr);
+    }
+}
+
+uint32_t BindlessSet::registerTexture(const AllocatedImage &texture) {
+    auto it = textureIndices.find(texture.view);
+    if (it != textureIndices.end()) {
+        return it->second;
+    }
+    if (textureCount >= textureCapacity) {
+        throw std::runtime_error("failed to register texture, bindless texture array is full");
+    }
+
+    // update after bind, the slot is unused by frames still in flight
+    uint32_t index = textureCount++;
+    for (VkDescriptorSet descriptorSet : descriptorSets) {
+        writeTexture(descriptorSet, index, texture.view);
+    }
+    textureIndices[texture.view] = index;
+    return index;
+}
+
+void BindlessSet::setTexture(uint32_t index, const AllocatedImage &texture) {
+    std::erase_if(textureIndices, [index](const auto &entry) { return entry.second == index; });
+    textureIndices[texture.view] = index;
+    for (auto &pending : pendingTextures) {
+        pending[index] = texture.view;
+    }
+}
+
+void BindlessSet::updateUniformBuffer(SceneUniformBufferObject uniformBuffer, uint32_t currentImage) {
+    memcpy(uniformBuffersMapped[currentImage], &uniformBuffer, sizeof(uniformBuffer));
+}
+
+void BindlessSet::writePendingTextures(size_t currentFrame) {
+    // the frame's previous submission has finished, so its set can take the swapped textures
+    for (auto &[index, view] : pendingTextures[currentFrame]) {
+        writeTexture(descriptorSets[currentFrame], index, view);
+    }
+    pendingTextures[currentFrame].clear();
+}
+
+void BindlessSet::bind(VkCommandBuffer cmdBuffer, VkPipelineLayout pipelineLayout, size_t currentFrame) {
+    vkCmdBindDescriptorSets(cmdBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &descriptorSets[currentFrame], 0, nullptr);
+}
+
+void BindlessSet::resetFeedback(uint32_t currentFrame) {
+    memset(feedbackMapped[currentFrame], 0xff, sizeof(uint32_t) * textureCapacity);
+}
+
+void BindlessSet::recordFeedbackBarrier(VkCommandBuffer cmdBuffer) {
+    VkMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(cmdBuffer, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &barrier, 0, nullptr, 0,
+                         nullptr);
+}
+
+void BindlessSet::writeTexture(VkDescriptorSet descriptorSet, uint32_t index, VkImageView view) {
+    VkDescriptorImageInfo imageInfo{};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = view;
+    // the sampler is immutable in the set layout
+    imageInfo.sampler = VK_NULL_HANDLE;
+
+    VkWriteDescriptorSet descriptorWrite{};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = descriptorSet;
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = index;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(lveDevice.device(), 1, &descriptorWrite, 0, nullptr);
+}
+
+void BindlessSet::createDescriptorSets(VkDescriptorSetLayout layout) {
+    uint32_t framesInFlight = lveDevice.getFramesInFlight();
+    std::vector<VkDescriptorPoolSize> poolSizes{};
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, framesInFlight});
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, framesInFlight * textureCapacity});
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, framesInFlight});
+    descriptorAllocator.createDescriptorPool(poolSizes, framesInFlight, VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    descriptorAllocator.allocateDescriptorSets(layout, descriptorSets);
+
+    for (size_t i = 0; i < descriptorSets.size(); i++) {
+        FrameDescriptors descriptors{};
+        descriptors.uniformBuffer = {uniformBuffers[i], 0, sizeof(SceneUniformBufferObject)};
+        descriptors.feedback = {feedbackBuffers[i], 0, sizeof(uint32_t) * textureCapacity};
+        lveDevice.descriptorTemplateCache().updateDescriptorSet(descriptorSets[i], layout, descriptors);
+    }
+}
+
+void BindlessSet::createUniformBuffers() {
+    VkDeviceSize bufferSize = sizeof(SceneUniformBufferObject);
+
+    uniformBuffers.resize(lveDevice.getFramesInFlight());
+    uniformBuffersMemory.resize(lveDevice.getFramesInFlight());
+    uniformBuffersMapped.resize(lveDevice.getFramesInFlight());
+
+    for (size_t i = 0; i < lveDevice.getFramesInFlight(); i++) {
+        lveDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i],
+                               uniformBuffersMemory[i]);
+
+        vkMapMemory(lveDevice.device(), uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+    }
+}
+
+void BindlessSet::createFeedbackBuffers() {
+    VkDeviceSize bufferSize = sizeof(uint32_t) * textureCapacity;
+
+    feedbackBuffers.resize(lveDevice.getFramesInFlight());
+    feedbackBuffersMemory.resize(lveDevice.getFramesInFlight());
+    feedbackMapped.resize(lveDevice.getFramesInFlight());
+
+    for (uint32_t i = 0; i < lveDevice.getFramesInFlight(); i++) {
+        lveDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, feedbackBuffers[i],
+                               feedbackBuffersMemory[i]);
+
+        vkMapMemory(lveDevice.device(), feedbackBuffersMemory[i], 0, bufferSize, 0, reinterpret_cast<void **>(&feedbackMapped[i]));
+        resetFeedback(i);
+    }
+}
+} // namespace lve
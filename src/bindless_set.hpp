@@ -0,0 +1,88 @@
+#pragma once
+
+#include "descriptor_allocator.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_types.hpp"
+
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+struct SceneUniformBufferObject {
+    glm::mat4 view;
+    glm::mat4 proj;
+};
+
+// Scene-wide descriptor set for the bindless pipelines, one per frame in flight. Holds the scene
+// uniforms and an array of every texture the scene uses. Textures are registered once and then
+// referenced by index through BindlessPushConstants, so a frame binds a single set.
+// The fragment shader also writes the finest mip level it wanted per texture index into a
+// feedback buffer, which TextureStreamer reads back once the frame has finished.
+class BindlessSet {
+public:
+    static constexpr uint32_t NO_FEEDBACK = UINT32_MAX;
+    // matches LOD_BIAS in bindless_shader.frag, keeps magnified (negative) lods unsigned
+    static constexpr int32_t FEEDBACK_LOD_BIAS = 16;
+
+    BindlessSet(LveDevice &device, VkDescriptorSetLayout layout);
+    ~BindlessSet();
+
+    // Not copyable or movable
+    BindlessSet(const BindlessSet &) = delete;
+    BindlessSet operator=(const BindlessSet &) = delete;
+    BindlessSet(BindlessSet &&) = delete;
+    BindlessSet &operator=(BindlessSet &&) = delete;
+
+    // registering the same texture twice returns the same index
+    uint32_t registerTexture(const AllocatedImage &texture);
+    // swaps the image behind an index, each frame's set picks it up in its next
+    // writePendingTextures so frames still in flight keep sampling the old image
+    void setTexture(uint32_t index, const AllocatedImage &texture);
+    void updateUniformBuffer(SceneUniformBufferObject uniformBuffer, uint32_t currentImage);
+    // writes the textures swapped since the frame's set was last used, call once per frame before
+    // the set is bound
+    void writePendingTextures(size_t currentFrame);
+    // only records the bind, so it can be called from several threads
+    void bind(VkCommandBuffer cmdBuffer, VkPipelineLayout pipelineLayout, size_t currentFrame);
+
+    // only valid once the frame was acquired, the frame that last wrote it has finished
+    const uint32_t *getFeedback(uint32_t currentFrame) { return feedbackMapped[currentFrame]; }
+    void resetFeedback(uint32_t currentFrame);
+    // makes the feedback writes of a frame visible to the host, record after the frame's draws
+    void recordFeedbackBarrier(VkCommandBuffer cmdBuffer);
+
+private:
+    // the bindings written once per set, textures are written per array element as they change
+    struct FrameDescriptors {
+        VkDescriptorBufferInfo uniformBuffer;
+        VkDescriptorBufferInfo feedback;
+
+        static const std::vector<DescriptorTemplateEntry> &templateEntries();
+    };
+
+    void createUniformBuffers();
+    void createFeedbackBuffers();
+    void createDescriptorSets(VkDescriptorSetLayout layout);
+    void writeTexture(VkDescriptorSet descriptorSet, uint32_t index, VkImageView view);
+
+    LveDevice &lveDevice;
+    DescriptorAllocator descriptorAllocator{lveDevice};
+    uint32_t textureCapacity;
+
+    std::vector<VkDescriptorSet> descriptorSets;
+    std::vector<VkBuffer> uniformBuffers;
+    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    std::vector<void *> uniformBuffersMapped;
+    std::vector<VkBuffer> feedbackBuffers;
+    std::vector<VkDeviceMemory> feedbackBuffersMemory;
+    std::vector<uint32_t *> feedbackMapped;
+    std::unordered_map<VkImageView, uint32_t> textureIndices;
+    uint32_t textureCount = 0;
+    // one per frame in flight, a texture is written into each frame's set before that set is bound
+    std::vector<std::unordered_map<uint32_t, VkImageView>> pendingTextures;
+};
+} // namespace lve
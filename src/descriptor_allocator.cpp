@@ -1,46 +1,301 @@
 #include "descriptor_allocator.hpp"
 
-#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <stdexcept>
 
 namespace lve {
+namespace {
+// sets in the descriptor buffer are handed out as their offset, plus one so none is null
+VkDescriptorSet toDescriptorSet(VkDeviceSize offset) {
+    static_assert(sizeof(VkDescriptorSet) == sizeof(uint64_t));
+    uint64_t bits = offset + 1;
+    VkDescriptorSet descriptorSet;
+    memcpy(&descriptorSet, &bits, sizeof(bits));
+    return descriptorSet;
+}
+
+VkDeviceSize toOffset(VkDescriptorSet descriptorSet) {
+    uint64_t bits;
+    memcpy(&bits, &descriptorSet, sizeof(bits));
+    return bits - 1;
+}
+} // namespace
+
 DescriptorAllocator::DescriptorAllocator(LveDevice &device) : device{device} {}
 
-DescriptorAllocator::~DescriptorAllocator() {}
+DescriptorAllocator::~DescriptorAllocator() { destroyDescriptorPools(); }
 
 void DescriptorAllocator::createDescriptorPool(std::vector<VkDescriptorPoolSize> poolSizes,
-                                               uint32_t maxSets) {
-    VkDescriptorPoolCreateInfo poolInfo{};
-    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
-    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
-    poolInfo.pPoolSizes = poolSizes.data();
-    poolInfo.maxSets = maxSets;
+                                               uint32_t maxSets,
+                                               VkDescriptorPoolCreateFlags flags) {
+    ratios.clear();
+    for (const VkDescriptorPoolSize &poolSize : poolSizes) {
+        float ratio = static_cast<float>(poolSize.descriptorCount) / std::max(1u, maxSets);
+        ratios.push_back({poolSize.type, ratio, ratio * MAX_RATIO_GROWTH});
+    }
+    poolFlags = flags;
+    setsPerPool = std::max(1u, maxSets);
 
-    if (vkCreateDescriptorPool(device.device(), &poolInfo, nullptr, &descriptorPool) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor pool");
+    // update-after-bind sets are rewritten while in use, they stay in pools
+    useDescriptorBuffer = device.isDescriptorBufferEnabled() &&
+                          !(flags & VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT);
+    if (useDescriptorBuffer) {
+        bytesPerSet = 0.0f;
+        for (const PoolRatio &ratio : ratios) {
+            bytesPerSet += ratio.ratio * device.descriptorBuffer().getDescriptorSize(ratio.type);
+        }
+        readyRanges.push_back(createRange(setsPerPool, 0));
+        return;
     }
+
+    readyPools.push_back(createPool(setsPerPool));
 }
 
 void DescriptorAllocator::allocateDescriptorSets(VkDescriptorSetLayout layout,
                                                  std::vector<VkDescriptorSet> &outDescriptorSets) {
-    std::vector<VkDescriptorSetLayout> layouts(LveSwapChain::MAX_FRAMES_IN_FLIGHT, layout);
+    std::vector<VkDescriptorSetLayout> layouts(device.getFramesInFlight(), layout);
+    outDescriptorSets.resize(device.getFramesInFlight());
+    allocate(layouts, outDescriptorSets.data());
+}
+
+VkDescriptorSet DescriptorAllocator::allocateDescriptorSet(VkDescriptorSetLayout layout) {
+    VkDescriptorSet descriptorSet;
+    allocate({layout}, &descriptorSet);
+    return descriptorSet;
+}
+
+void DescriptorAllocator::allocate(const std::vector<VkDescriptorSetLayout> &layouts,
+                                   VkDescriptorSet *outDescriptorSets) {
+    if (useDescriptorBuffer) {
+        allocateFromBuffer(layouts, outDescriptorSets);
+        return;
+    }
+
+    uint32_t setCount = static_cast<uint32_t>(layouts.size());
+    VkDescriptorPool pool = getPool();
+
     VkDescriptorSetAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-    allocInfo.descriptorPool = descriptorPool;
-    allocInfo.descriptorSetCount = static_cast<uint32_t>(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
+    allocInfo.descriptorPool = pool;
+    allocInfo.descriptorSetCount = setCount;
     allocInfo.pSetLayouts = layouts.data();
 
-    outDescriptorSets.resize(LveSwapChain::MAX_FRAMES_IN_FLIGHT);
-    if (vkAllocateDescriptorSets(device.device(), &allocInfo, outDescriptorSets.data()) !=
-        VK_SUCCESS) {
+    VkResult result = vkAllocateDescriptorSets(device.device(), &allocInfo, outDescriptorSets);
+    // every new pool is larger, large or variable count sets may take a few to fit
+    while (result == VK_ERROR_OUT_OF_POOL_MEMORY || result == VK_ERROR_FRAGMENTED_POOL) {
+        PoolUsage &usage = poolUsage.at(pool);
+        if (usage.allocatedSets == 0 && usage.maxSets == MAX_SETS_PER_POOL) {
+            throw std::runtime_error("failed to allocate descriptor sets, they do not fit the largest pool");
+        }
+        if (usage.allocatedSets + setCount <= usage.maxSets) {
+            correctRatios(usage);
+        }
+        fullPools.push_back(pool);
+        readyPools.pop_back();
+
+        pool = getPool();
+        allocInfo.descriptorPool = pool;
+        result = vkAllocateDescriptorSets(device.device(), &allocInfo, outDescriptorSets);
+    }
+    if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate descriptor sets");
     }
+    poolUsage.at(pool).allocatedSets += setCount;
+}
+
+VkDescriptorPool DescriptorAllocator::getPool() {
+    if (ratios.empty()) {
+        throw std::runtime_error("failed to allocate descriptor sets, no pool was created");
+    }
+    if (readyPools.empty()) {
+        setsPerPool = std::min(setsPerPool + setsPerPool / 2 + 1, MAX_SETS_PER_POOL);
+        readyPools.push_back(createPool(setsPerPool));
+    }
+    return readyPools.back();
+}
+
+VkDescriptorPool DescriptorAllocator::createPool(uint32_t setCount) {
+    std::vector<VkDescriptorPoolSize> poolSizes;
+    for (const PoolRatio &ratio : ratios) {
+        double descriptorCount = std::ceil(static_cast<double>(ratio.ratio) * setCount);
+        descriptorCount = std::clamp(descriptorCount, 1.0, static_cast<double>(UINT32_MAX));
+        poolSizes.push_back({ratio.type, static_cast<uint32_t>(descriptorCount)});
+    }
+
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = poolFlags;
+    poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+    poolInfo.pPoolSizes = poolSizes.data();
+    poolInfo.maxSets = setCount;
+
+    VkDescriptorPool pool;
+    if (vkCreateDescriptorPool(device.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor pool");
+    }
+    poolUsage[pool] = {setCount, 0};
+    return pool;
+}
+
+void DescriptorAllocator::correctRatios(const PoolUsage &usage) {
+    // the very first allocation did not fit, there is nothing to measure and the next pool is
+    // larger anyway
+    if (usage.allocatedSets == 0) {
+        return;
+    }
+    // descriptors ran out first, the pool held fewer sets than it was sized for. The pool does not
+    // say which type ran out, so every ratio is scaled to what the allocated sets really used.
+    float scale = std::min(static_cast<float>(usage.maxSets) / usage.allocatedSets, MAX_RATIO_SCALE);
+    for (PoolRatio &ratio : ratios) {
+        ratio.ratio = std::min(ratio.ratio * scale, ratio.maxRatio);
+    }
+}
+
+void DescriptorAllocator::allocateFromBuffer(const std::vector<VkDescriptorSetLayout> &layouts,
+                                             VkDescriptorSet *outDescriptorSets) {
+    for (size_t i = 0; i < layouts.size(); i++) {
+        VkDeviceSize setSize = device.descriptorBuffer().getLayoutSize(layouts[i]);
+        BufferRange &range = getRange(setSize);
+        outDescriptorSets[i] = toDescriptorSet(range.offset + range.used);
+        range.used += setSize;
+        range.allocatedSets++;
+    }
+}
+
+DescriptorAllocator::BufferRange &DescriptorAllocator::getRange(VkDeviceSize minSize) {
+    if (ratios.empty()) {
+        throw std::runtime_error("failed to allocate descriptor sets, no pool was created");
+    }
+    while (!readyRanges.empty() && readyRanges.back().used + minSize > readyRanges.back().size) {
+        const BufferRange &range = readyRanges.back();
+        // the layouts took more bytes than the ratios suggested
+        if (range.allocatedSets > 0) {
+            bytesPerSet =
+                std::max(bytesPerSet, static_cast<float>(range.used) / range.allocatedSets);
+        }
+        fullRanges.push_back(range);
+        readyRanges.pop_back();
+    }
+    if (readyRanges.empty()) {
+        setsPerPool = std::min(setsPerPool + setsPerPool / 2 + 1, MAX_SETS_PER_POOL);
+        readyRanges.push_back(createRange(setsPerPool, minSize));
+    }
+    return readyRanges.back();
+}
+
+DescriptorAllocator::BufferRange DescriptorAllocator::createRange(uint32_t setCount,
+                                                                  VkDeviceSize minSize) {
+    VkDeviceSize size =
+        std::max(static_cast<VkDeviceSize>(std::ceil(bytesPerSet * setCount)), minSize);
+    return {device.descriptorBuffer().allocateRange(size), size, 0, 0};
+}
+
+void DescriptorAllocator::writeDescriptorSet(VkDescriptorSet descriptorSet,
+                                             VkDescriptorSetLayout layout,
+                                             const std::vector<DescriptorTemplateEntry> &entries,
+                                             const void *descriptors) {
+    if (useDescriptorBuffer) {
+        device.descriptorBuffer().writeDescriptorSet(toOffset(descriptorSet), layout, entries,
+                                                     descriptors);
+        return;
+    }
+    VkDescriptorUpdateTemplate updateTemplate =
+        device.descriptorTemplateCache().getTemplate(layout, entries);
+    vkUpdateDescriptorSetWithTemplate(device.device(), descriptorSet, updateTemplate, descriptors);
+}
+
+void DescriptorAllocator::bindDescriptorSet(VkCommandBuffer commandBuffer,
+                                            VkPipelineBindPoint bindPoint,
+                                            VkPipelineLayout pipelineLayout,
+                                            VkDescriptorSet descriptorSet) {
+    if (useDescriptorBuffer) {
+        device.descriptorBuffer().bindDescriptorSet(commandBuffer, bindPoint, pipelineLayout,
+                                                    toOffset(descriptorSet));
+        return;
+    }
+    vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &descriptorSet, 0,
+                            nullptr);
+}
+
+void DescriptorAllocator::resetPools() {
+    for (VkDescriptorPool pool : fullPools) {
+        readyPools.push_back(pool);
+    }
+    fullPools.clear();
+    for (VkDescriptorPool pool : readyPools) {
+        vkResetDescriptorPool(device.device(), pool, 0);
+        poolUsage.at(pool).allocatedSets = 0;
+    }
+
+    for (const BufferRange &range : fullRanges) {
+        readyRanges.push_back(range);
+    }
+    fullRanges.clear();
+    for (BufferRange &range : readyRanges) {
+        range.used = 0;
+        range.allocatedSets = 0;
+    }
+}
+
+void DescriptorAllocator::destroyDescriptorPools() {
+    for (VkDescriptorPool pool : readyPools) {
+        vkDestroyDescriptorPool(device.device(), pool, nullptr);
+    }
+    for (VkDescriptorPool pool : fullPools) {
+        vkDestroyDescriptorPool(device.device(), pool, nullptr);
+    }
+    readyPools.clear();
+    fullPools.clear();
+    poolUsage.clear();
+
+    for (const BufferRange &range : readyRanges) {
+        device.descriptorBuffer().freeRange(range.offset, range.size);
+    }
+    for (const BufferRange &range : fullRanges) {
+        device.descriptorBuffer().freeRange(range.offset, range.size);
+    }
+    readyRanges.clear();
+    fullRanges.clear();
+    useDescriptorBuffer = false;
+    ratios.clear();
+}
+
+FrameDescriptorAllocator::FrameDescriptorAllocator(LveDevice &device) {
+    for (uint32_t i = 0; i < device.getFramesInFlight(); i++) {
+        frameAllocators.push_back(std::make_unique<DescriptorAllocator>(device));
+    }
+}
+
+void FrameDescriptorAllocator::createDescriptorPools(
+    const std::vector<VkDescriptorPoolSize> &poolSizes, uint32_t maxSets) {
+    for (auto &allocator : frameAllocators) {
+        allocator->createDescriptorPool(poolSizes, maxSets);
+    }
+}
+
+void FrameDescriptorAllocator::beginFrame(uint32_t currentFrame) {
+    frameIndex = currentFrame;
+    frameAllocators[frameIndex]->resetPools();
+}
+
+VkDescriptorSet FrameDescriptorAllocator::allocate(VkDescriptorSetLayout layout) {
+    return frameAllocators[frameIndex]->allocateDescriptorSet(layout);
+}
+
+void FrameDescriptorAllocator::bindDescriptorSet(VkCommandBuffer commandBuffer,
+                                                 VkPipelineBindPoint bindPoint,
+                                                 VkPipelineLayout pipelineLayout,
+                                                 VkDescriptorSet descriptorSet) {
+    frameAllocators[frameIndex]->bindDescriptorSet(commandBuffer, bindPoint, pipelineLayout,
+                                                   descriptorSet);
 }
 
-void DescriptorAllocator::destroyDescriptorPool() {
-    if (descriptorPool) {
-        vkDestroyDescriptorPool(device.device(), descriptorPool, nullptr);
+void FrameDescriptorAllocator::destroyDescriptorPools() {
+    for (auto &allocator : frameAllocators) {
+        allocator->destroyDescriptorPools();
     }
 }
-} // namespace lve
\ No newline at end of file
+} // namespace lve
@@ -2,9 +2,27 @@
 
 #include "lve_swap_chain.hpp"
 
+// std
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 namespace lve {
+// Hands out descriptor sets from a chain of pools. When a pool runs out another one is created
+// with the same ratio of descriptors to sets and half again as many sets. If a pool ran out of
+// descriptors before sets, the ratios are corrected from what was actually allocated from it.
+// When the device has descriptor buffers (and the pool is not update-after-bind) the "pools" are
+// ranges of the device's DescriptorBuffer instead, sets are sub-allocated from them and the
+// returned VkDescriptorSet only encodes the set's offset. Such sets must be written and bound
+// through the allocator, see writeDescriptorSet and bindDescriptorSet.
 class DescriptorAllocator {
 public:
+    static constexpr uint32_t MAX_SETS_PER_POOL = 4092;
+    // a correction scales the ratios by at most this, and a ratio never grows past
+    // MAX_RATIO_GROWTH times the one the first pool was created with
+    static constexpr float MAX_RATIO_SCALE = 4.0f;
+    static constexpr float MAX_RATIO_GROWTH = 16.0f;
+
     DescriptorAllocator(LveDevice &device);
     ~DescriptorAllocator();
 
@@ -14,13 +32,113 @@ public:
     DescriptorAllocator(DescriptorAllocator &&) = delete;
     DescriptorAllocator &operator=(DescriptorAllocator &&) = delete;
 
-    void createDescriptorPool(std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets);
+    // creates the first pool, its sizes over maxSets give the descriptors expected per set
+    void createDescriptorPool(std::vector<VkDescriptorPoolSize> poolSizes, uint32_t maxSets,
+                              VkDescriptorPoolCreateFlags flags = 0);
+    // one set per frame in flight
     void allocateDescriptorSets(VkDescriptorSetLayout layout,
                                 std::vector<VkDescriptorSet> &outDescriptorSets);
-    void destroyDescriptorPool();
+    VkDescriptorSet allocateDescriptorSet(VkDescriptorSetLayout layout);
+    // writes every binding a descriptor struct lists, see DescriptorTemplateEntry
+    void writeDescriptorSet(VkDescriptorSet descriptorSet, VkDescriptorSetLayout layout,
+                            const std::vector<DescriptorTemplateEntry> &entries,
+                            const void *descriptors);
+    template <typename T>
+    void writeDescriptorSet(VkDescriptorSet descriptorSet, VkDescriptorSetLayout layout,
+                            const T &descriptors) {
+        writeDescriptorSet(descriptorSet, layout, T::templateEntries(), &descriptors);
+    }
+    // binds the set as set 0 of the pipeline layout
+    void bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                           VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+    // returns every set to its pool, none of them may still be in use by the GPU
+    void resetPools();
+    void destroyDescriptorPools();
+
+    size_t getPoolCount() {
+        return readyPools.size() + fullPools.size() + readyRanges.size() + fullRanges.size();
+    }
+    bool usesDescriptorBuffer() { return useDescriptorBuffer; }
 
 private:
-    VkDescriptorPool descriptorPool;
+    struct PoolRatio {
+        VkDescriptorType type;
+        float ratio;
+        float maxRatio;
+    };
+
+    struct PoolUsage {
+        uint32_t maxSets;
+        uint32_t allocatedSets;
+    };
+
+    // a range of the descriptor buffer standing in for a pool
+    struct BufferRange {
+        VkDeviceSize offset;
+        VkDeviceSize size;
+        VkDeviceSize used;
+        uint32_t allocatedSets;
+    };
+
+    void allocate(const std::vector<VkDescriptorSetLayout> &layouts,
+                  VkDescriptorSet *outDescriptorSets);
+    VkDescriptorPool getPool();
+    VkDescriptorPool createPool(uint32_t setCount);
+    void correctRatios(const PoolUsage &usage);
+    void allocateFromBuffer(const std::vector<VkDescriptorSetLayout> &layouts,
+                            VkDescriptorSet *outDescriptorSets);
+    BufferRange &getRange(VkDeviceSize minSize);
+    BufferRange createRange(uint32_t setCount, VkDeviceSize minSize);
+
     LveDevice &device;
+    std::vector<PoolRatio> ratios;
+    VkDescriptorPoolCreateFlags poolFlags = 0;
+    uint32_t setsPerPool = 0;
+
+    // pools that may still have room, the last one is allocated from first
+    std::vector<VkDescriptorPool> readyPools;
+    std::vector<VkDescriptorPool> fullPools;
+    std::unordered_map<VkDescriptorPool, PoolUsage> poolUsage;
+
+    bool useDescriptorBuffer = false;
+    // estimated from the ratios, raised when a range holds fewer sets than expected
+    float bytesPerSet = 0.0f;
+    std::vector<BufferRange> readyRanges;
+    std::vector<BufferRange> fullRanges;
+};
+
+// Descriptor sets that only live for one frame. Each frame in flight allocates from its own
+// DescriptorAllocator, whose pools are reset as a whole once the frame last recorded with them has
+// finished instead of freeing sets one by one.
+class FrameDescriptorAllocator {
+public:
+    FrameDescriptorAllocator(LveDevice &device);
+
+    // Not copyable or movable
+    FrameDescriptorAllocator(const FrameDescriptorAllocator &) = delete;
+    FrameDescriptorAllocator operator=(const FrameDescriptorAllocator &) = delete;
+    FrameDescriptorAllocator(FrameDescriptorAllocator &&) = delete;
+    FrameDescriptorAllocator &operator=(FrameDescriptorAllocator &&) = delete;
+
+    // sizes are per frame
+    void createDescriptorPools(const std::vector<VkDescriptorPoolSize> &poolSizes,
+                               uint32_t maxSets);
+    // call after the frame was acquired, sets allocated for it last time are recycled
+    void beginFrame(uint32_t currentFrame);
+    VkDescriptorSet allocate(VkDescriptorSetLayout layout);
+    // sets allocated this frame
+    template <typename T>
+    void writeDescriptorSet(VkDescriptorSet descriptorSet, VkDescriptorSetLayout layout,
+                            const T &descriptors) {
+        frameAllocators[frameIndex]->writeDescriptorSet(descriptorSet, layout, descriptors);
+    }
+    void bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint,
+                           VkPipelineLayout pipelineLayout, VkDescriptorSet descriptorSet);
+    void destroyDescriptorPools();
+
+private:
+    // one per frame in flight
+    std::vector<std::unique_ptr<DescriptorAllocator>> frameAllocators;
+    uint32_t frameIndex = 0;
 };
-} // namespace lve
\ No newline at end of file
+} // namespace lve
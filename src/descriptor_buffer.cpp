@@ -0,0 +1,216 @@
+#include "descriptor_buffer.hpp"
+#include "lve_device.hpp"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+bool isImageDescriptor(VkDescriptorType type) {
+    return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+           type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+           type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+}
+} // namespace
+
+DescriptorBuffer::DescriptorBuffer(LveDevice &device) : device{device} {
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+    VkPhysicalDeviceProperties2 properties2{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &properties};
+    vkGetPhysicalDeviceProperties2(device.physicalDevice(), &properties2);
+
+    loadFunctions();
+    createBuffer();
+}
+
+DescriptorBuffer::~DescriptorBuffer() {
+    vkUnmapMemory(device.device(), memory);
+    vkDestroyBuffer(device.device(), buffer, nullptr);
+    vkFreeMemory(device.device(), memory, nullptr);
+}
+
+void DescriptorBuffer::loadFunctions() {
+    VkDevice vkDevice = device.device();
+    vkGetDescriptorSetLayoutSize =
+        reinterpret_cast<PFN_vkGetDescriptorSetLayoutSizeEXT>(vkGetDeviceProcAddr(vkDevice, "vkGetDescriptorSetLayoutSizeEXT"));
+    vkGetDescriptorSetLayoutBindingOffset = reinterpret_cast<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(
+        vkGetDeviceProcAddr(vkDevice, "vkGetDescriptorSetLayoutBindingOffsetEXT"));
+    vkGetDescriptor = reinterpret_cast<PFN_vkGetDescriptorEXT>(vkGetDeviceProcAddr(vkDevice, "vkGetDescriptorEXT"));
+    vkCmdBindDescriptorBuffers =
+        reinterpret_cast<PFN_vkCmdBindDescriptorBuffersEXT>(vkGetDeviceProcAddr(vkDevice, "vkCmdBindDescriptorBuffersEXT"));
+    vkCmdSetDescriptorBufferOffsets =
+        reinterpret_cast<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(vkGetDeviceProcAddr(vkDevice, "vkCmdSetDescriptorBufferOffsetsEXT"));
+
+    if (!vkGetDescriptorSetLayoutSize || !vkGetDescriptorSetLayoutBindingOffset || !vkGetDescriptor || !vkCmdBindDescriptorBuffers ||
+        !vkCmdSetDescriptorBufferOffsets) {
+        throw std::runtime_error("failed to load descriptor buffer functions!");
+    }
+}
+
+void DescriptorBuffer::createBuffer() {
+    // sets are bound relative to the start of the buffer, all of it has to be addressable
+    size = std::min({BUFFER_SIZE, properties.maxResourceDescriptorBufferRange, properties.maxSamplerDescriptorBufferRange});
+    size = size / getOffsetAlignment() * getOffsetAlignment();
+
+    device.createBuffer(size,
+                        VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT |
+                            VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, buffer, memory);
+    void *data;
+    if (vkMapMemory(device.device(), memory, 0, size, 0, &data) != VK_SUCCESS) {
+        throw std::runtime_error("failed to map descriptor buffer!");
+    }
+    mapped = static_cast<uint8_t *>(data);
+    address = getBufferAddress(buffer);
+
+    freeRanges[0] = size;
+}
+
+VkDeviceAddress DescriptorBuffer::getBufferAddress(VkBuffer addressedBuffer) {
+    VkBufferDeviceAddressInfo addressInfo{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO};
+    addressInfo.buffer = addressedBuffer;
+    return vkGetBufferDeviceAddress(device.device(), &addressInfo);
+}
+
+VkDeviceSize DescriptorBuffer::allocateRange(VkDeviceSize rangeSize) {
+    rangeSize = alignUp(rangeSize);
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto it = freeRanges.begin(); it != freeRanges.end(); it++) {
+        auto [offset, freeSize] = *it;
+        if (freeSize < rangeSize) {
+            continue;
+        }
+        freeRanges.erase(it);
+        if (freeSize > rangeSize) {
+            freeRanges[offset + rangeSize] = freeSize - rangeSize;
+        }
+        return offset;
+    }
+    throw std::runtime_error("failed to allocate descriptor buffer range, the buffer is full");
+}
+
+void DescriptorBuffer::freeRange(VkDeviceSize offset, VkDeviceSize rangeSize) {
+    rangeSize = alignUp(rangeSize);
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = freeRanges.emplace(offset, rangeSize).first;
+
+    // merge with the free ranges on either side
+    auto next = std::next(it);
+    if (next != freeRanges.end() && it->first + it->second == next->first) {
+        it->second += next->second;
+        freeRanges.erase(next);
+    }
+    if (it != freeRanges.begin()) {
+        auto previous = std::prev(it);
+        if (previous->first + previous->second == it->first) {
+            previous->second += it->second;
+            freeRanges.erase(it);
+        }
+    }
+}
+
+VkDeviceSize DescriptorBuffer::getLayoutSize(VkDescriptorSetLayout layout) {
+    VkDeviceSize layoutSize;
+    vkGetDescriptorSetLayoutSize(device.device(), layout, &layoutSize);
+    return alignUp(layoutSize);
+}
+
+VkDeviceSize DescriptorBuffer::getDescriptorSize(VkDescriptorType type) {
+    switch (type) {
+    case VK_DESCRIPTOR_TYPE_SAMPLER:
+        return properties.samplerDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+        return properties.combinedImageSamplerDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+        return properties.sampledImageDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+        return properties.storageImageDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER:
+        return properties.uniformTexelBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER:
+        return properties.storageTexelBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
+        return properties.uniformBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER:
+        return properties.storageBufferDescriptorSize;
+    case VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT:
+        return properties.inputAttachmentDescriptorSize;
+    default:
+        throw std::runtime_error("failed to size descriptor, type not supported by the descriptor buffer");
+    }
+}
+
+void DescriptorBuffer::writeDescriptorSet(VkDeviceSize offset, VkDescriptorSetLayout layout,
+                                          const std::vector<DescriptorTemplateEntry> &entries, const void *descriptors) {
+    const uint8_t *data = static_cast<const uint8_t *>(descriptors);
+    for (const DescriptorTemplateEntry &entry : entries) {
+        VkDeviceSize bindingOffset;
+        vkGetDescriptorSetLayoutBindingOffset(device.device(), layout, entry.binding, &bindingOffset);
+        VkDeviceSize descriptorSize = getDescriptorSize(entry.type);
+
+        for (uint32_t i = 0; i < entry.count; i++) {
+            const uint8_t *element = data + entry.offset + i * entry.stride;
+            VkDescriptorGetInfoEXT getInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT};
+            getInfo.type = entry.type;
+
+            VkDescriptorImageInfo imageInfo;
+            VkDescriptorAddressInfoEXT addressInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT};
+            if (isImageDescriptor(entry.type)) {
+                memcpy(&imageInfo, element, sizeof(imageInfo));
+                if (imageInfo.sampler == VK_NULL_HANDLE) {
+                    imageInfo.sampler = device.descriptorLayoutCache().getImmutableSampler(layout, entry.binding, i);
+                }
+                switch (entry.type) {
+                case VK_DESCRIPTOR_TYPE_SAMPLER:
+                    getInfo.data.pSampler = &imageInfo.sampler;
+                    break;
+                case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER:
+                    getInfo.data.pCombinedImageSampler = &imageInfo;
+                    break;
+                case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE:
+                    getInfo.data.pSampledImage = &imageInfo;
+                    break;
+                case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE:
+                    getInfo.data.pStorageImage = &imageInfo;
+                    break;
+                default:
+                    getInfo.data.pInputAttachmentImage = &imageInfo;
+                    break;
+                }
+            } else {
+                VkDescriptorBufferInfo bufferInfo;
+                memcpy(&bufferInfo, element, sizeof(bufferInfo));
+                if (bufferInfo.range == VK_WHOLE_SIZE) {
+                    throw std::runtime_error("failed to write descriptor buffer, buffer ranges need an explicit size");
+                }
+                addressInfo.address = getBufferAddress(bufferInfo.buffer) + bufferInfo.offset;
+                addressInfo.range = bufferInfo.range;
+                if (entry.type == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER) {
+                    getInfo.data.pUniformBuffer = &addressInfo;
+                } else if (entry.type == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER) {
+                    getInfo.data.pStorageBuffer = &addressInfo;
+                } else {
+                    throw std::runtime_error("failed to write descriptor buffer, texel buffers are not supported");
+                }
+            }
+
+            vkGetDescriptor(device.device(), &getInfo, descriptorSize, mapped + offset + bindingOffset + i * descriptorSize);
+        }
+    }
+}
+
+void DescriptorBuffer::bindBuffer(VkCommandBuffer commandBuffer) {
+    VkDescriptorBufferBindingInfoEXT bindingInfo{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT};
+    bindingInfo.address = address;
+    bindingInfo.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+    vkCmdBindDescriptorBuffers(commandBuffer, 1, &bindingInfo);
+}
+
+void DescriptorBuffer::bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                                         VkDeviceSize offset) {
+    uint32_t bufferIndex = 0;
+    vkCmdSetDescriptorBufferOffsets(commandBuffer, bindPoint, pipelineLayout, 0, 1, &bufferIndex, &offset);
+}
+} // namespace lve
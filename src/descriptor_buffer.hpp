@@ -0,0 +1,76 @@
+#pragma once
+
+#include "descriptor_template_cache.hpp"
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace lve {
+class LveDevice;
+
+// Device-wide host visible buffer that descriptor sets are written into directly with
+// VK_EXT_descriptor_buffer, instead of being allocated from descriptor pools. The buffer is split
+// into ranges that DescriptorAllocators sub-allocate sets from, and a set is bound by its offset.
+// Only created when the device supports the extension, see LveDevice::isDescriptorBufferEnabled.
+class DescriptorBuffer {
+public:
+    static constexpr VkDeviceSize BUFFER_SIZE = 4 * 1024 * 1024;
+
+    explicit DescriptorBuffer(LveDevice &device);
+    ~DescriptorBuffer();
+
+    DescriptorBuffer(const DescriptorBuffer &) = delete;
+    DescriptorBuffer &operator=(const DescriptorBuffer &) = delete;
+
+    // first fit, the offset is aligned for descriptor sets
+    VkDeviceSize allocateRange(VkDeviceSize size);
+    void freeRange(VkDeviceSize offset, VkDeviceSize size);
+
+    // bytes a set of the layout takes, rounded up so the next set stays aligned
+    VkDeviceSize getLayoutSize(VkDescriptorSetLayout layout);
+    VkDeviceSize getDescriptorSize(VkDescriptorType type);
+    VkDeviceSize getOffsetAlignment() { return properties.descriptorBufferOffsetAlignment; }
+    VkDeviceSize getSize() { return size; }
+
+    // writes every binding a descriptor struct lists into the set at offset, null samplers are
+    // taken from the layout's immutable samplers
+    void writeDescriptorSet(VkDeviceSize offset, VkDescriptorSetLayout layout, const std::vector<DescriptorTemplateEntry> &entries,
+                            const void *descriptors);
+    // once per command buffer, before any set is bound
+    void bindBuffer(VkCommandBuffer commandBuffer);
+    void bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                           VkDeviceSize offset);
+
+private:
+    void loadFunctions();
+    void createBuffer();
+    VkDeviceAddress getBufferAddress(VkBuffer buffer);
+    VkDeviceSize alignUp(VkDeviceSize value) {
+        VkDeviceSize alignment = getOffsetAlignment();
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    LveDevice &device;
+    VkPhysicalDeviceDescriptorBufferPropertiesEXT properties{};
+    PFN_vkGetDescriptorSetLayoutSizeEXT vkGetDescriptorSetLayoutSize = nullptr;
+    PFN_vkGetDescriptorSetLayoutBindingOffsetEXT vkGetDescriptorSetLayoutBindingOffset = nullptr;
+    PFN_vkGetDescriptorEXT vkGetDescriptor = nullptr;
+    PFN_vkCmdBindDescriptorBuffersEXT vkCmdBindDescriptorBuffers = nullptr;
+    PFN_vkCmdSetDescriptorBufferOffsetsEXT vkCmdSetDescriptorBufferOffsets = nullptr;
+
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    uint8_t *mapped = nullptr;
+    VkDeviceAddress address = 0;
+    VkDeviceSize size = 0;
+
+    std::mutex mutex;
+    // offset to size of every unallocated range
+    std::map<VkDeviceSize, VkDeviceSize> freeRanges;
+};
+} // namespace lve
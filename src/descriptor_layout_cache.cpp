@@ -0,0 +1,117 @@
+#include "descriptor_layout_cache.hpp"
+
+// std
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+template <typename T> void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // namespace
+
+DescriptorLayoutCache::DescriptorLayoutCache(VkDevice device) : device{device} {}
+
+DescriptorLayoutCache::~DescriptorLayoutCache() {
+    for (auto &[key, layout] : layouts) {
+        vkDestroyDescriptorSetLayout(device, layout, nullptr);
+    }
+}
+
+VkDescriptorSetLayout DescriptorLayoutCache::getLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                                       VkDescriptorSetLayoutCreateFlags flags,
+                                                       const std::vector<VkDescriptorBindingFlags> &bindingFlags) {
+    if (!bindingFlags.empty() && bindingFlags.size() != bindings.size()) {
+        throw std::runtime_error("failed to create descriptor set layout, binding flags do not match bindings");
+    }
+
+    LayoutKey key{flags, {}};
+    for (size_t i = 0; i < bindings.size(); i++) {
+        const VkDescriptorSetLayoutBinding &binding = bindings[i];
+        BindingKey bindingKey{binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags,
+                              bindingFlags.empty() ? 0 : bindingFlags[i], {}};
+        if (binding.pImmutableSamplers) {
+            bindingKey.immutableSamplers.assign(binding.pImmutableSamplers, binding.pImmutableSamplers + binding.descriptorCount);
+        }
+        key.bindings.push_back(std::move(bindingKey));
+    }
+    // the same bindings listed in another order describe the same layout
+    std::sort(key.bindings.begin(), key.bindings.end(),
+              [](const BindingKey &a, const BindingKey &b) { return a.binding < b.binding; });
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = layouts.find(key);
+    if (it != layouts.end()) {
+        hits++;
+        return it->second;
+    }
+    misses++;
+
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+    bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = bindingFlags.empty() ? nullptr : &bindingFlagsInfo;
+    layoutInfo.flags = flags;
+    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+    layoutInfo.pBindings = bindings.data();
+
+    VkDescriptorSetLayout layout;
+    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &layout) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor set layout!");
+    }
+    auto inserted = layouts.emplace(std::move(key), layout).first;
+    layoutKeys[layout] = &inserted->first;
+    return layout;
+}
+
+VkSampler DescriptorLayoutCache::getImmutableSampler(VkDescriptorSetLayout layout, uint32_t binding, uint32_t arrayElement) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = layoutKeys.find(layout);
+    if (it == layoutKeys.end()) {
+        return VK_NULL_HANDLE;
+    }
+    for (const BindingKey &bindingKey : it->second->bindings) {
+        if (bindingKey.binding == binding && arrayElement < bindingKey.immutableSamplers.size()) {
+            return bindingKey.immutableSamplers[arrayElement];
+        }
+    }
+    return VK_NULL_HANDLE;
+}
+
+size_t DescriptorLayoutCache::size() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return layouts.size();
+}
+
+uint64_t DescriptorLayoutCache::getHits() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return hits;
+}
+
+uint64_t DescriptorLayoutCache::getMisses() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return misses;
+}
+
+size_t DescriptorLayoutCache::LayoutKeyHash::operator()(const LayoutKey &key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.flags);
+    for (const BindingKey &binding : key.bindings) {
+        hashCombine(seed, binding.binding);
+        hashCombine(seed, static_cast<int>(binding.type));
+        hashCombine(seed, binding.count);
+        hashCombine(seed, binding.stages);
+        hashCombine(seed, binding.flags);
+        for (VkSampler sampler : binding.immutableSamplers) {
+            hashCombine(seed, sampler);
+        }
+    }
+    return seed;
+}
+} // namespace lve
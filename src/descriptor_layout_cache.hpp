@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Device-wide cache of descriptor set layouts keyed by their bindings, so pipelines declaring the
+// same bindings share one layout. Layouts live until the device is destroyed, callers never
+// destroy a layout returned from here.
+class DescriptorLayoutCache {
+public:
+    explicit DescriptorLayoutCache(VkDevice device);
+    ~DescriptorLayoutCache();
+
+    DescriptorLayoutCache(const DescriptorLayoutCache &) = delete;
+    DescriptorLayoutCache &operator=(const DescriptorLayoutCache &) = delete;
+
+    // bindingFlags is either empty or holds one entry per binding
+    VkDescriptorSetLayout getLayout(const std::vector<VkDescriptorSetLayoutBinding> &bindings,
+                                    VkDescriptorSetLayoutCreateFlags flags = 0,
+                                    const std::vector<VkDescriptorBindingFlags> &bindingFlags = {});
+    // the immutable sampler baked into a binding of a layout from this cache, or VK_NULL_HANDLE
+    VkSampler getImmutableSampler(VkDescriptorSetLayout layout, uint32_t binding, uint32_t arrayElement = 0);
+    size_t size();
+    uint64_t getHits();
+    uint64_t getMisses();
+
+private:
+    struct BindingKey {
+        uint32_t binding;
+        VkDescriptorType type;
+        uint32_t count;
+        VkShaderStageFlags stages;
+        VkDescriptorBindingFlags flags;
+        std::vector<VkSampler> immutableSamplers;
+
+        bool operator==(const BindingKey &other) const = default;
+    };
+
+    struct LayoutKey {
+        VkDescriptorSetLayoutCreateFlags flags;
+        // sorted by binding number
+        std::vector<BindingKey> bindings;
+
+        bool operator==(const LayoutKey &other) const = default;
+    };
+
+    struct LayoutKeyHash {
+        size_t operator()(const LayoutKey &key) const;
+    };
+
+    VkDevice device;
+    std::mutex mutex;
+    std::unordered_map<LayoutKey, VkDescriptorSetLayout, LayoutKeyHash> layouts;
+    // keys of the map above, which never moves its nodes
+    std::unordered_map<VkDescriptorSetLayout, const LayoutKey *> layoutKeys;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+} // namespace lve
@@ -0,0 +1,81 @@
+#include "descriptor_set_cache.hpp"
+
+// std
+#include <cstring>
+#include <functional>
+
+namespace lve {
+namespace {
+template <typename T> void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+
+// non-dispatchable handles are pointers or integers depending on the platform
+template <typename T> uint64_t keyBits(const T &value) {
+    uint64_t bits = 0;
+    memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+bool isImageDescriptor(VkDescriptorType type) {
+    return type == VK_DESCRIPTOR_TYPE_SAMPLER || type == VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER ||
+           type == VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE || type == VK_DESCRIPTOR_TYPE_STORAGE_IMAGE ||
+           type == VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+}
+} // namespace
+
+DescriptorSetCache::DescriptorSetCache(DescriptorAllocator &descriptorAllocator) : descriptorAllocator{descriptorAllocator} {}
+
+VkDescriptorSet DescriptorSetCache::getDescriptorSet(VkDescriptorSetLayout layout, const std::vector<DescriptorTemplateEntry> &entries,
+                                                     const void *descriptors) {
+    SetKey key{layout, {}};
+    const uint8_t *data = static_cast<const uint8_t *>(descriptors);
+    for (const DescriptorTemplateEntry &entry : entries) {
+        for (uint32_t i = 0; i < entry.count; i++) {
+            const uint8_t *element = data + entry.offset + i * entry.stride;
+            if (isImageDescriptor(entry.type)) {
+                VkDescriptorImageInfo imageInfo;
+                memcpy(&imageInfo, element, sizeof(imageInfo));
+                key.resources.push_back(keyBits(imageInfo.sampler));
+                key.resources.push_back(keyBits(imageInfo.imageView));
+                key.resources.push_back(keyBits(imageInfo.imageLayout));
+            } else {
+                VkDescriptorBufferInfo bufferInfo;
+                memcpy(&bufferInfo, element, sizeof(bufferInfo));
+                key.resources.push_back(keyBits(bufferInfo.buffer));
+                key.resources.push_back(bufferInfo.offset);
+                key.resources.push_back(bufferInfo.range);
+            }
+        }
+    }
+
+    auto it = descriptorSets.find(key);
+    if (it != descriptorSets.end()) {
+        hits++;
+        return it->second;
+    }
+    misses++;
+
+    VkDescriptorSet descriptorSet = descriptorAllocator.allocateDescriptorSet(layout);
+    descriptorAllocator.writeDescriptorSet(descriptorSet, layout, entries, descriptors);
+
+    descriptorSets.emplace(std::move(key), descriptorSet);
+    return descriptorSet;
+}
+
+void DescriptorSetCache::bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                                           VkDescriptorSet descriptorSet) {
+    descriptorAllocator.bindDescriptorSet(commandBuffer, bindPoint, pipelineLayout, descriptorSet);
+}
+
+void DescriptorSetCache::clear() { descriptorSets.clear(); }
+
+size_t DescriptorSetCache::SetKeyHash::operator()(const SetKey &key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.layout);
+    for (uint64_t resource : key.resources) {
+        hashCombine(seed, resource);
+    }
+    return seed;
+}
+} // namespace lve
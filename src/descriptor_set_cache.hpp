@@ -0,0 +1,62 @@
+#pragma once
+
+#include "descriptor_allocator.hpp"
+#include "descriptor_template_cache.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Descriptor sets keyed by their layout and the resources bound to them. A set is allocated and
+// written through an update template the first time a combination is asked for, after that every
+// caller binding the same resources gets the same set and no descriptors are written again.
+// Cached sets reference the resources by handle, so clear the cache before any of them is destroyed.
+class DescriptorSetCache {
+public:
+    explicit DescriptorSetCache(DescriptorAllocator &descriptorAllocator);
+
+    // Not copyable or movable
+    DescriptorSetCache(const DescriptorSetCache &) = delete;
+    DescriptorSetCache &operator=(const DescriptorSetCache &) = delete;
+    DescriptorSetCache(DescriptorSetCache &&) = delete;
+    DescriptorSetCache &operator=(DescriptorSetCache &&) = delete;
+
+    // T is a descriptor struct, see DescriptorTemplateEntry
+    template <typename T> VkDescriptorSet getDescriptorSet(VkDescriptorSetLayout layout, const T &descriptors) {
+        return getDescriptorSet(layout, T::templateEntries(), &descriptors);
+    }
+    // sets from the cache are bound through their allocator, they may live in a descriptor buffer
+    void bindDescriptorSet(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                           VkDescriptorSet descriptorSet);
+    // forgets every set, their memory goes back with the allocator's pools
+    void clear();
+
+    size_t size() { return descriptorSets.size(); }
+    uint64_t getHits() { return hits; }
+    uint64_t getMisses() { return misses; }
+
+private:
+    struct SetKey {
+        VkDescriptorSetLayout layout;
+        // the handles, offsets and layouts of every descriptor, padding in the struct is skipped
+        std::vector<uint64_t> resources;
+
+        bool operator==(const SetKey &other) const = default;
+    };
+
+    struct SetKeyHash {
+        size_t operator()(const SetKey &key) const;
+    };
+
+    VkDescriptorSet getDescriptorSet(VkDescriptorSetLayout layout, const std::vector<DescriptorTemplateEntry> &entries,
+                                     const void *descriptors);
+
+    DescriptorAllocator &descriptorAllocator;
+    std::unordered_map<SetKey, VkDescriptorSet, SetKeyHash> descriptorSets;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
+} // namespace lve
@@ -0,0 +1,115 @@
+#include "descriptor_template_cache.hpp"
+
+// std
+#include <functional>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+template <typename T> void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // namespace
+
+DescriptorTemplateCache::DescriptorTemplateCache(VkDevice device) : device{device} {
+    // null unless VK_KHR_push_descriptor is enabled
+    vkCmdPushDescriptorSetWithTemplate = reinterpret_cast<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(
+        vkGetDeviceProcAddr(device, "vkCmdPushDescriptorSetWithTemplateKHR"));
+}
+
+DescriptorTemplateCache::~DescriptorTemplateCache() {
+    for (auto &[key, updateTemplate] : templates) {
+        vkDestroyDescriptorUpdateTemplate(device, updateTemplate, nullptr);
+    }
+}
+
+VkDescriptorUpdateTemplate DescriptorTemplateCache::getTemplate(VkDescriptorSetLayout layout,
+                                                                const std::vector<DescriptorTemplateEntry> &entries) {
+    return getTemplate({layout, VK_NULL_HANDLE, VK_PIPELINE_BIND_POINT_GRAPHICS, entries});
+}
+
+VkDescriptorUpdateTemplate DescriptorTemplateCache::getPushTemplate(VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                                                                    VkDescriptorSetLayout layout,
+                                                                    const std::vector<DescriptorTemplateEntry> &entries) {
+    if (!vkCmdPushDescriptorSetWithTemplate) {
+        throw std::runtime_error("failed to create push descriptor template, VK_KHR_push_descriptor is not enabled");
+    }
+    return getTemplate({layout, pipelineLayout, bindPoint, entries});
+}
+
+VkDescriptorUpdateTemplate DescriptorTemplateCache::getTemplate(TemplateKey key) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = templates.find(key);
+    if (it != templates.end()) {
+        return it->second;
+    }
+
+    std::vector<VkDescriptorUpdateTemplateEntry> templateEntries;
+    for (const DescriptorTemplateEntry &entry : key.entries) {
+        VkDescriptorUpdateTemplateEntry templateEntry{};
+        templateEntry.dstBinding = entry.binding;
+        templateEntry.dstArrayElement = 0;
+        templateEntry.descriptorCount = entry.count;
+        templateEntry.descriptorType = entry.type;
+        templateEntry.offset = entry.offset;
+        templateEntry.stride = entry.stride;
+        templateEntries.push_back(templateEntry);
+    }
+
+    VkDescriptorUpdateTemplateCreateInfo templateInfo{};
+    templateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+    templateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(templateEntries.size());
+    templateInfo.pDescriptorUpdateEntries = templateEntries.data();
+    templateInfo.descriptorSetLayout = key.layout;
+    if (key.pipelineLayout == VK_NULL_HANDLE) {
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+    } else {
+        templateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+        templateInfo.pipelineBindPoint = key.bindPoint;
+        templateInfo.pipelineLayout = key.pipelineLayout;
+        templateInfo.set = 0;
+    }
+
+    VkDescriptorUpdateTemplate updateTemplate;
+    if (vkCreateDescriptorUpdateTemplate(device, &templateInfo, nullptr, &updateTemplate) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create descriptor update template!");
+    }
+    templates.emplace(std::move(key), updateTemplate);
+    return updateTemplate;
+}
+
+void DescriptorTemplateCache::evictLayout(VkPipelineLayout pipelineLayout) {
+    // set templates are keyed with a null pipeline layout
+    if (pipelineLayout == VK_NULL_HANDLE) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{mutex};
+    std::erase_if(templates, [this, pipelineLayout](const auto &entry) {
+        if (entry.first.pipelineLayout != pipelineLayout) {
+            return false;
+        }
+        vkDestroyDescriptorUpdateTemplate(device, entry.second, nullptr);
+        return true;
+    });
+}
+
+size_t DescriptorTemplateCache::size() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return templates.size();
+}
+
+size_t DescriptorTemplateCache::TemplateKeyHash::operator()(const TemplateKey &key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.layout);
+    hashCombine(seed, key.pipelineLayout);
+    hashCombine(seed, static_cast<int>(key.bindPoint));
+    for (const DescriptorTemplateEntry &entry : key.entries) {
+        hashCombine(seed, entry.binding);
+        hashCombine(seed, static_cast<int>(entry.type));
+        hashCombine(seed, entry.offset);
+        hashCombine(seed, entry.stride);
+        hashCombine(seed, entry.count);
+    }
+    return seed;
+}
+} // namespace lve
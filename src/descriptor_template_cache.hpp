@@ -0,0 +1,85 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// One binding of a descriptor struct. A descriptor struct is a plain struct of
+// VkDescriptorBufferInfo / VkDescriptorImageInfo members with a static templateEntries() listing
+// where each binding lives in it, so a whole set is written from it in one call.
+struct DescriptorTemplateEntry {
+    uint32_t binding;
+    VkDescriptorType type;
+    size_t offset;
+    size_t stride;
+    uint32_t count = 1;
+
+    static DescriptorTemplateEntry buffer(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count = 1) {
+        return {binding, type, offset, sizeof(VkDescriptorBufferInfo), count};
+    }
+    static DescriptorTemplateEntry image(uint32_t binding, VkDescriptorType type, size_t offset, uint32_t count = 1) {
+        return {binding, type, offset, sizeof(VkDescriptorImageInfo), count};
+    }
+
+    bool operator==(const DescriptorTemplateEntry &other) const = default;
+};
+
+// Device-wide cache of descriptor update templates, created once per set layout and descriptor
+// struct, push descriptor templates also per pipeline layout. Push descriptor templates are
+// dropped with their pipeline layout through evictLayout, the others live until the device is
+// destroyed.
+class DescriptorTemplateCache {
+public:
+    explicit DescriptorTemplateCache(VkDevice device);
+    ~DescriptorTemplateCache();
+
+    DescriptorTemplateCache(const DescriptorTemplateCache &) = delete;
+    DescriptorTemplateCache &operator=(const DescriptorTemplateCache &) = delete;
+
+    VkDescriptorUpdateTemplate getTemplate(VkDescriptorSetLayout layout, const std::vector<DescriptorTemplateEntry> &entries);
+    // layout is a push descriptor set layout, pushed as set 0 of pipelineLayout
+    VkDescriptorUpdateTemplate getPushTemplate(VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout,
+                                               VkDescriptorSetLayout layout, const std::vector<DescriptorTemplateEntry> &entries);
+    // destroys the push descriptor templates for pipelineLayout, call before destroying it
+    void evictLayout(VkPipelineLayout pipelineLayout);
+    size_t size();
+
+    // writes every binding T lists with a single vkUpdateDescriptorSetWithTemplate
+    template <typename T> void updateDescriptorSet(VkDescriptorSet descriptorSet, VkDescriptorSetLayout layout, const T &descriptors) {
+        vkUpdateDescriptorSetWithTemplate(device, descriptorSet, getTemplate(layout, T::templateEntries()), &descriptors);
+    }
+    // records the descriptor struct into the command buffer as set 0, updateTemplate is from getPushTemplate
+    void pushDescriptorSet(VkCommandBuffer commandBuffer, VkDescriptorUpdateTemplate updateTemplate, VkPipelineLayout pipelineLayout,
+                           const void *descriptors) {
+        vkCmdPushDescriptorSetWithTemplate(commandBuffer, updateTemplate, pipelineLayout, 0, descriptors);
+    }
+
+private:
+    struct TemplateKey {
+        VkDescriptorSetLayout layout;
+        // VK_NULL_HANDLE unless the template pushes descriptors
+        VkPipelineLayout pipelineLayout;
+        VkPipelineBindPoint bindPoint;
+        std::vector<DescriptorTemplateEntry> entries;
+
+        bool operator==(const TemplateKey &other) const = default;
+    };
+
+    struct TemplateKeyHash {
+        size_t operator()(const TemplateKey &key) const;
+    };
+
+    VkDescriptorUpdateTemplate getTemplate(TemplateKey key);
+
+    VkDevice device;
+    PFN_vkCmdPushDescriptorSetWithTemplateKHR vkCmdPushDescriptorSetWithTemplate = nullptr;
+    std::mutex mutex;
+    std::unordered_map<TemplateKey, VkDescriptorUpdateTemplate, TemplateKeyHash> templates;
+};
+} // namespace lve
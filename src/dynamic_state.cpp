@@ -0,0 +1,26 @@
+#include "dynamic_state.hpp"
+
+namespace lve {
+DynamicState::DynamicState(VkDevice device, bool depthCullDynamic, bool blendDynamic)
+    : depthCullDynamic{depthCullDynamic}, blendDynamic{blendDynamic} {
+    // the cull and depth commands are core, only blend enable is loaded from the extension
+    if (blendDynamic) {
+        vkCmdSetColorBlendEnable =
+            reinterpret_cast<PFN_vkCmdSetColorBlendEnableEXT>(vkGetDeviceProcAddr(device, "vkCmdSetColorBlendEnableEXT"));
+    }
+}
+
+void DynamicState::apply(VkCommandBuffer cmd, const RenderState &state) {
+    if (depthCullDynamic) {
+        vkCmdSetCullMode(cmd, state.cullMode);
+        vkCmdSetDepthTestEnable(cmd, state.depthTest ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthWriteEnable(cmd, state.depthWrite ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthCompareOp(cmd, state.depthCompareOp);
+    }
+    if (blendDynamic) {
+        // the engine renders to a single color attachment
+        VkBool32 blendEnable = state.blend ? VK_TRUE : VK_FALSE;
+        vkCmdSetColorBlendEnable(cmd, 0, 1, &blendEnable);
+    }
+}
+} // namespace lve
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "lve_types.hpp"
+
+#include <vulkan/vulkan.h>
+
+namespace lve {
+// Sets the RenderState of a draw batch as command buffer state. Cull mode and the depth state are
+// core in Vulkan 1.3, blend enable comes from VK_EXT_extended_dynamic_state3. Whatever the
+// device does not support stays baked into the pipeline, see PipelineBuilder::setRenderState.
+class DynamicState {
+public:
+    DynamicState(VkDevice device, bool depthCullDynamic, bool blendDynamic);
+
+    // Not copyable or movable
+    DynamicState(const DynamicState &) = delete;
+    DynamicState &operator=(const DynamicState &) = delete;
+    DynamicState(DynamicState &&) = delete;
+    DynamicState &operator=(DynamicState &&) = delete;
+
+    bool isDepthCullDynamic() { return depthCullDynamic; }
+    bool isBlendDynamic() { return blendDynamic; }
+    // after binding a pipeline built with the same dynamic states, before its first draw
+    void apply(VkCommandBuffer cmd, const RenderState &state);
+
+private:
+    bool depthCullDynamic;
+    bool blendDynamic;
+    PFN_vkCmdSetColorBlendEnableEXT vkCmdSetColorBlendEnable = nullptr;
+};
+} // namespace lve
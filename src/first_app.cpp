@@ -16,28 +16,66 @@
 #include <stdexcept>
 
 namespace lve {
-FirstApp::FirstApp() {
-    init::createPipelines(lveDevice.device(), &lveSwapChain, &applicationPipelines);
-    init::createComputePipelines(lveDevice.device(), &lveSwapChain, &applicationPipelines);
-    sceneManager = std::make_unique<SceneManager>(lveDevice, applicationPipelines, lveWindow.getWindow());
+FirstApp::FirstApp(const FirstAppSettings &settings)
+    : lveDevice{lveWindow, settings.framesInFlight}, lveSwapChain{lveDevice, lveWindow.getExtent(), settings.presentMode},
+      framePacer{lveDevice, lveSwapChain, settings.targetFps} {
+    submitPipelines();
+    // the first scene only waits for the pipelines it draws with
+    sceneManager = std::make_unique<SceneManager>(lveDevice, applicationPipelines, pipelineCompiler, threadPool, assetCache,
+                                                  lveWindow.getWindow());
     createCommandBuffers();
 }
 
-FirstApp::~FirstApp() { destroyApplicationPipelines(lveDevice.device(), applicationPipelines); }
+FirstApp::~FirstApp() {
+    sceneManager.reset();
+    pipelineCompiler.waitIdle();
+    lveDevice.pipelineRegistry().waitIdle();
+    destroyApplicationPipelines(lveDevice, applicationPipelines);
+}
+
+void FirstApp::submitPipelines() {
+    // each group writes its own members of applicationPipelines. The first scene starts the groups
+    // it waits for, the rest start after the first frame so its texture loads are not queued behind them
+    pipelineCompiler.submit(
+        PipelineGroup::Graphics, [this] { init::createPipelines(&lveDevice, &lveSwapChain, &applicationPipelines); }, true);
+    applicationPipelines.bindless = lveDevice.isBindlessSupported();
+    if (applicationPipelines.bindless) {
+        pipelineCompiler.submit(
+            PipelineGroup::Bindless, [this] { init::createBindlessPipelines(&lveDevice, &lveSwapChain, &applicationPipelines); },
+            true);
+    }
+    pipelineCompiler.submit(
+        PipelineGroup::Compute, [this] { init::createComputePipelines(&lveDevice, &lveSwapChain, &applicationPipelines); }, true);
+}
 
 void FirstApp::run() {
     while (!lveWindow.shouldClose()) {
+        // sleeps until input should be sampled for the next frame to be shown on time
+        framePacer.beginFrame();
         glfwPollEvents();
 
+        // edited shaders are swapped in between frames
+        if (shaderReloader.update()) {
+            sceneManager->getCurrentScene()->reloadPipelines();
+        }
+        // fast linked pipelines are replaced by optimized ones as they finish compiling
+        lveDevice.pipelineRegistry().update(threadPool);
+
         ImGui_ImplVulkan_NewFrame();
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
         sceneManager->showSceneSelectGui();
         sceneManager->getCurrentScene()->showSceneGui();
+        framePacer.showGui();
 
         ImGui::Render();
 
         drawFrame();
+        framePacer.endFrame();
+        if (!startedPipelines) {
+            pipelineCompiler.startDeferred();
+            startedPipelines = true;
+        }
 
         if (sceneManager->shouldChangeScene()) {
             sceneManager->changeScene();
@@ -48,7 +86,7 @@ void FirstApp::run() {
 }
 
 void FirstApp::createCommandBuffers() {
-    commandBuffers.resize(lveSwapChain.imageCount());
+    commandBuffers.resize(lveSwapChain.getFramesInFlight());
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -69,30 +107,35 @@ void FirstApp::drawFrame() {
         throw std::runtime_error("failed to acquire swap chain image");
     }
 
-    lveSwapChain.waitForFrameFence(&imageIndex);
+    // the frame that last recorded into this command buffer has finished, acquireNextImage waited for it
+    uint32_t currentFrame = static_cast<uint32_t>(lveSwapChain.getCurrentFrame());
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    vkResetCommandBuffer(commandBuffer, 0);
 
-    vkResetCommandBuffer(commandBuffers[imageIndex], 0);
+    // before recording, scenes may push per frame state like the model transform as constants
+    sceneManager->getCurrentScene()->updateUniformBuffer(currentFrame, lveSwapChain.width(), lveSwapChain.height());
 
     VkCommandBufferBeginInfo beginInfo = init::commandBufferBeginInfo();
 
-    if (vkBeginCommandBuffer(commandBuffers[imageIndex], &beginInfo) != VK_SUCCESS) {
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
         throw std::runtime_error("failed to begin recording command buffer");
     }
+    if (lveDevice.isDescriptorBufferEnabled()) {
+        lveDevice.descriptorBuffer().bindBuffer(commandBuffer);
+    }
 
-    sceneManager->getCurrentScene()->draw(commandBuffers[imageIndex], lveSwapChain, imageIndex, lveSwapChain.getCurrentFrame());
+    sceneManager->getCurrentScene()->draw(commandBuffer, lveSwapChain, imageIndex, currentFrame);
 
-    lveGui.draw(commandBuffers[imageIndex], lveSwapChain.getImageView(imageIndex));
+    lveGui.draw(commandBuffer, lveSwapChain.getImageView(imageIndex));
 
-    util::transitionImageLayout(commandBuffers[imageIndex], lveSwapChain.getImage(imageIndex), lveSwapChain.getSwapChainImageFormat(),
+    util::transitionImageLayout(commandBuffer, lveSwapChain.getImage(imageIndex), lveSwapChain.getSwapChainImageFormat(),
                                 VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR);
 
-    if (vkEndCommandBuffer(commandBuffers[imageIndex]) != VK_SUCCESS) {
+    if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
         throw std::runtime_error("failed to record command buffer");
     }
 
-    sceneManager->getCurrentScene()->updateUniformBuffer(lveSwapChain.getCurrentFrame(), lveSwapChain.width(), lveSwapChain.height());
-
-    result = lveSwapChain.submitCommandBuffers(&commandBuffers[imageIndex], &imageIndex);
+    result = lveSwapChain.submitCommandBuffers(&commandBuffer, &imageIndex);
     if (result != VK_SUCCESS) {
         throw std::runtime_error("failed to present swap chain image");
     }
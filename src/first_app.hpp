@@ -1,24 +1,37 @@
 #pragma once
 
+#include "asset_cache.hpp"
+#include "frame_pacer.hpp"
 #include "gui.hpp"
 #include "lve_device.hpp"
 #include "lve_swap_chain.hpp"
 #include "lve_types.hpp"
 #include "lve_window.hpp"
 #include "model.hpp"
+#include "pipeline_compiler.hpp"
 #include "scene_manager.hpp"
+#include "shader_reloader.hpp"
+#include "utility/thread_pool.hpp"
 
 // std
 #include <memory>
 #include <vector>
 
 namespace lve {
+// chosen per deployment, see main
+struct FirstAppSettings {
+    uint32_t framesInFlight = LveDevice::DEFAULT_FRAMES_IN_FLIGHT;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+    // 0 leaves the frame rate to the present mode
+    uint32_t targetFps = 0;
+};
+
 class FirstApp {
 public:
     static constexpr int WIDTH = 1600;
     static constexpr int HEIGHT = 900;
 
-    FirstApp();
+    explicit FirstApp(const FirstAppSettings &settings = {});
     ~FirstApp();
 
     FirstApp(const FirstApp &) = delete;
@@ -26,6 +39,7 @@ public:
     void run();
 
 private:
+    void submitPipelines();
     void createCommandBuffers();
     void drawFrame();
 
@@ -33,9 +47,17 @@ private:
     LveDevice lveDevice{lveWindow};
     LveSwapChain lveSwapChain{lveDevice, lveWindow.getExtent()};
     LveGui lveGui{lveDevice, lveSwapChain, lveWindow};
+    FramePacer framePacer;
+    // one per frame in flight
     std::vector<VkCommandBuffer> commandBuffers;
 
     ApplicationPipelines applicationPipelines;
+    util::ThreadPool threadPool;
+    PipelineCompiler pipelineCompiler{threadPool};
+    // the groups the first scene does not use are started after its first frame
+    bool startedPipelines = false;
+    ShaderReloader shaderReloader{lveDevice, lveSwapChain, applicationPipelines, pipelineCompiler, threadPool};
+    AssetCache assetCache{lveDevice, threadPool};
     std::unique_ptr<SceneManager> sceneManager;
 };
 } // namespace lve
\ No newline at end of file
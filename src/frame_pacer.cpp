@@ -0,0 +1,86 @@
+#include "frame_pacer.hpp"
+#include "imgui.h"
+
+// std
+#include <thread>
+
+namespace lve {
+FramePacer::FramePacer(LveDevice &device, LveSwapChain &swapChain, uint32_t targetFps)
+    : device{device}, swapChain{swapChain}, targetFps{static_cast<int>(targetFps)},
+      waitForPreviousPresent{device.isPresentWaitEnabled()} {}
+
+void FramePacer::beginFrame() {
+    auto start = std::chrono::steady_clock::now();
+    if (device.isPresentWaitEnabled()) {
+        waitForPresents();
+    }
+    limitFrameRate();
+
+    inputTime = std::chrono::steady_clock::now();
+    float waitTime = std::chrono::duration<float, std::milli>(inputTime - start).count();
+    waitMilliseconds = waitMilliseconds * 0.95f + waitTime * 0.05f;
+}
+
+void FramePacer::endFrame() {
+    if (device.isPresentWaitEnabled()) {
+        pendingPresents.push_back({swapChain.getPresentId(), inputTime});
+    }
+}
+
+void FramePacer::waitForPresents() {
+    // the frame before this one has to be on screen before input for this one is sampled, with
+    // FIFO that holds the loop at one frame of latency instead of framesInFlight
+    if (waitForPreviousPresent && !pendingPresents.empty()) {
+        swapChain.waitForPresent(pendingPresents.back().presentId, PRESENT_TIMEOUT_NS);
+    }
+
+    // without waiting, presents are only noticed here, so latency reads up to a frame high
+    while (!pendingPresents.empty()) {
+        VkResult result = swapChain.waitForPresent(pendingPresents.front().presentId, 0);
+        if (result == VK_TIMEOUT) {
+            break;
+        }
+        if (result == VK_SUCCESS) {
+            lastLatencyMilliseconds =
+                std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - pendingPresents.front().inputTime)
+                    .count();
+            latencyMilliseconds = latencyMilliseconds * 0.95f + lastLatencyMilliseconds * 0.05f;
+        }
+        pendingPresents.pop_front();
+    }
+}
+
+void FramePacer::limitFrameRate() {
+    if (targetFps <= 0) {
+        return;
+    }
+    auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / targetFps));
+    auto now = std::chrono::steady_clock::now();
+    // after a stall, or when the limit was just turned on, frames are paced from now instead of catching up
+    if (nextFrameTime + period < now) {
+        nextFrameTime = now;
+    }
+
+    if (nextFrameTime - now > SPIN_MARGIN) {
+        std::this_thread::sleep_until(nextFrameTime - SPIN_MARGIN);
+    }
+    while (std::chrono::steady_clock::now() < nextFrameTime) {
+        std::this_thread::yield();
+    }
+    nextFrameTime += period;
+}
+
+void FramePacer::showGui() {
+    ImGui::Begin("Frame Pacing");
+    ImGui::Text("Present mode: %s", LveSwapChain::getPresentModeName(swapChain.getPresentMode()));
+    ImGui::SliderInt("Target FPS (0 = off)", &targetFps, 0, 240);
+    if (device.isPresentWaitEnabled()) {
+        ImGui::Checkbox("Wait for previous present", &waitForPreviousPresent);
+        ImGui::Text("Input to present: %.1f ms, last %.1f ms", latencyMilliseconds, lastLatencyMilliseconds);
+    } else {
+        ImGui::Text("Input to present: unavailable without VK_KHR_present_wait");
+    }
+    ImGui::Text("Paced: %.2f ms per frame", waitMilliseconds);
+    ImGui::End();
+}
+} // namespace lve
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_swap_chain.hpp"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <deque>
+
+namespace lve {
+// Keeps the frame loop from rendering frames that are never shown. beginFrame sleeps until the
+// target frame time and, with VK_KHR_present_wait, until the previous frame is on screen, so
+// input is sampled as late as possible before the frame that uses it. Each present is matched to
+// the time its input was sampled to measure input-to-present latency.
+class FramePacer {
+public:
+    // sleeps overshoot by up to a scheduler tick, the last stretch before a deadline is spun
+    static constexpr std::chrono::microseconds SPIN_MARGIN{1000};
+    // a present that is not on screen by then, e.g. of a minimized window, stops being waited for
+    static constexpr uint64_t PRESENT_TIMEOUT_NS = 100'000'000;
+
+    // targetFps of 0 leaves the frame rate to the present mode
+    FramePacer(LveDevice &device, LveSwapChain &swapChain, uint32_t targetFps);
+
+    // Not copyable or movable
+    FramePacer(const FramePacer &) = delete;
+    FramePacer &operator=(const FramePacer &) = delete;
+    FramePacer(FramePacer &&) = delete;
+    FramePacer &operator=(FramePacer &&) = delete;
+
+    // call right before input is polled
+    void beginFrame();
+    // call after the frame was presented
+    void endFrame();
+    void showGui();
+
+private:
+    struct PendingPresent {
+        uint64_t presentId;
+        std::chrono::steady_clock::time_point inputTime;
+    };
+
+    void waitForPresents();
+    void limitFrameRate();
+
+    LveDevice &device;
+    LveSwapChain &swapChain;
+
+    // edited from the GUI
+    int targetFps;
+    bool waitForPreviousPresent;
+    std::chrono::steady_clock::time_point nextFrameTime{};
+    std::chrono::steady_clock::time_point inputTime{};
+    std::deque<PendingPresent> pendingPresents;
+
+    float latencyMilliseconds = 0.0f;
+    float lastLatencyMilliseconds = 0.0f;
+    // spent in beginFrame, the CPU time pacing saves
+    float waitMilliseconds = 0.0f;
+};
+} // namespace lve
@@ -2,6 +2,7 @@
 
 #include "initializers/initializers.hpp"
 
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 
@@ -55,7 +56,8 @@ void LveGui::init() {
     initInfo.Queue = device.graphicsQueue();
     initInfo.DescriptorPool = imguiPool;
     initInfo.MinImageCount = 3;
-    initInfo.ImageCount = 3;
+    // ImGui cycles its vertex buffers through ImageCount frames, they must outlast the frames in flight
+    initInfo.ImageCount = std::max(3u, device.getFramesInFlight());
     initInfo.UseDynamicRendering = true;
     initInfo.MSAASamples = VK_SAMPLE_COUNT_1_BIT;
     initInfo.PipelineRenderingCreateInfo = renderingInfo;
@@ -5,14 +5,14 @@
 namespace init {
 void createImage(lve::LveDevice *device, uint32_t width, uint32_t height, VkFormat format,
                  VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-                 lve::AllocatedImage &image) {
+                 lve::AllocatedImage &image, uint32_t mipLevels) {
     VkImageCreateInfo imageInfo{};
     imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
     imageInfo.imageType = VK_IMAGE_TYPE_2D;
     imageInfo.extent.width = static_cast<uint32_t>(width);
     imageInfo.extent.height = static_cast<uint32_t>(height);
     imageInfo.extent.depth = 1;
-    imageInfo.mipLevels = 1;
+    imageInfo.mipLevels = mipLevels;
     imageInfo.arrayLayers = 1;
     imageInfo.format = format;
     imageInfo.tiling = tiling;
@@ -24,10 +24,11 @@ void createImage(lve::LveDevice *device, uint32_t width, uint32_t height, VkForm
 
     device->createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image.image,
                                 image.memory);
-    image.view = device->createImageView(image.image, format);
+    image.view = device->createImageView(image.image, format, mipLevels);
+    image.mipLevels = mipLevels;
 }
 
-void createImageSampler(VkDevice device, float maxAnisotropy, VkSampler &outTextureSampler) {
+VkSamplerCreateInfo textureSamplerCreateInfo(float maxAnisotropy) {
     VkSamplerCreateInfo samplerInfo{};
     samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
     samplerInfo.magFilter = VK_FILTER_LINEAR;
@@ -44,10 +45,12 @@ void createImageSampler(VkDevice device, float maxAnisotropy, VkSampler &outText
     samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
     samplerInfo.mipLodBias = 0.0f;
     samplerInfo.minLod = 0.0f;
-    samplerInfo.maxLod = 0.0f;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    return samplerInfo;
+}
 
-    if (vkCreateSampler(device, &samplerInfo, nullptr, &outTextureSampler) != VK_SUCCESS) {
-        throw std::runtime_error("failed to create texture sampler!");
-    }
+VkSampler getTextureSampler(lve::LveDevice *device) {
+    return device->samplerCache().getSampler(
+        textureSamplerCreateInfo(device->properties.limits.maxSamplerAnisotropy));
 }
 } // namespace init
\ No newline at end of file
@@ -6,6 +6,8 @@
 namespace init {
 void createImage(lve::LveDevice *device, uint32_t width, uint32_t height, VkFormat format,
                  VkImageTiling tiling, VkImageUsageFlags usage, VkMemoryPropertyFlags properties,
-                 lve::AllocatedImage &image);
-void createImageSampler(VkDevice device, float maxAnisotropy, VkSampler &outTextureSampler);
+                 lve::AllocatedImage &image, uint32_t mipLevels = 1);
+VkSamplerCreateInfo textureSamplerCreateInfo(float maxAnisotropy);
+// shared through the device sampler cache, never destroy the returned sampler
+VkSampler getTextureSampler(lve::LveDevice *device);
 } // namespace init
\ No newline at end of file
@@ -12,12 +12,4 @@ VkRenderingInfo renderingInfo(VkExtent2D renderExtent, VkRenderingAttachmentInfo
                               VkRenderingAttachmentInfo *depthAttachment);
 VkSubmitInfo2 submitInfo(VkCommandBufferSubmitInfo *cmd, VkSemaphoreSubmitInfo *signalSemaphoreInfo,
                          VkSemaphoreSubmitInfo *waitSemaphoreInfo);
-
-template <typename T> VkPushConstantRange pushConstants(VkShaderStageFlags flags) {
-    VkPushConstantRange pushConstant{};
-    pushConstant.offset = 0;
-    pushConstant.size = sizeof(T);
-    pushConstant.stageFlags = flags;
-    return pushConstant;
-}
 } // namespace init
\ No newline at end of file
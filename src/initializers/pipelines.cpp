@@ -1,42 +1,78 @@
 #include "pipelines.hpp"
 #include "../lve_types.hpp"
+#include "../shader_permutation.hpp"
+#include "../shader_reflection.hpp"
+#include "images.hpp"
 #include "initializers.hpp"
 
+#include <algorithm>
 #include <array>
+#include <map>
 #include <stdexcept>
+#include <string>
+#include <utility>
 #include <vector>
 
 namespace init {
-void createPipelines(VkDevice device, lve::LveSwapChain *swapChain,
+namespace {
+const lve::RenderState OPAQUE_STATE{};
+// drawn last over the opaque geometry, both faces and without touching depth
+const lve::RenderState TRANSPARENT_STATE{VK_CULL_MODE_NONE, false, false, VK_COMPARE_OP_NEVER,
+                                         true};
+
+// the materials the scenes load, see DemoScene::loadModels. A material without its own variant
+// uses the smallest one that has its features
+const std::vector<lve::ShaderFeatures> GRAPHICS_VARIANTS = {
+    lve::SHADER_FEATURE_TEXTURED,
+    lve::SHADER_FEATURE_ALPHA_BLEND,
+    lve::SHADER_FEATURE_TEXTURED | lve::SHADER_FEATURE_ALPHA_BLEND,
+};
+
+// with extended dynamic state the opaque and transparent states build the same pipeline, otherwise
+// the registry creates a static variant per state
+void setDynamicState(lve::LveDevice *lveDevice, lve::PipelineBuilder &pipelineBuilder) {
+    pipelineBuilder.dynamicDepthCull = lveDevice->dynamicState().isDepthCullDynamic();
+    pipelineBuilder.dynamicBlend = lveDevice->dynamicState().isBlendDynamic();
+}
+} // namespace
+
+void createPipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
                      lve::ApplicationPipelines *outPipelines) {
-    // opaque pipeline
-    // descriptor sets
-    VkDescriptorSetLayoutBinding uboLayoutBinding{};
-    uboLayoutBinding.binding = 0;
-    uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-    uboLayoutBinding.descriptorCount = 1;
-    uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
-    uboLayoutBinding.pImmutableSamplers = nullptr;
-
-    VkDescriptorSetLayoutBinding samplerLayoutBinding{};
-    samplerLayoutBinding.binding = 1;
-    samplerLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
-    samplerLayoutBinding.descriptorCount = 1;
-    samplerLayoutBinding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
-    samplerLayoutBinding.pImmutableSamplers = nullptr;
-
-    std::array<VkDescriptorSetLayoutBinding, 2> bindings = {uboLayoutBinding, samplerLayoutBinding};
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    VkDescriptorSetLayout descriptorSetLayout;
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
+    VkDevice device = lveDevice->device();
+    lve::PipelineRegistry &registry = lveDevice->pipelineRegistry();
+    lve::ShaderCompiler &shaders = lveDevice->shaderCompiler();
+
+    const std::string vertPath = "shaders/simple_shader.vert";
+    const std::string fragPath = "shaders/simple_shader.frag";
+    lve::ShaderPermutations permutations{{vertPath, fragPath}};
+    std::vector<lve::ShaderFeatures> variants = permutations.getVariants(GRAPHICS_VARIANTS);
+
+    // the layout comes from the variant with every feature, so it has every binding a leaner
+    // variant could use
+    std::vector<std::string> vertDefines = permutations.getDefines(vertPath, variants[0]);
+    std::vector<std::string> fragDefines = permutations.getDefines(fragPath, variants[0]);
+    std::vector<uint32_t> vertCode = shaders.compile(vertPath, vertDefines);
+    std::vector<uint32_t> fragCode = shaders.compile(fragPath, fragDefines);
+    lve::ShaderReflection reflection{vertCode};
+    reflection.merge(lve::ShaderReflection{fragCode});
+
+    // every model samples with the same state, so bake it into the layout
+    VkSampler textureSampler = getTextureSampler(lveDevice);
+    reflection.setImmutableSamplers(0, 1, &textureSampler);
+
+    // with push descriptors every draw pushes its bindings and no sets are allocated, with
+    // descriptor buffers the sets are written into the device's descriptor buffer instead of
+    // allocated from pools, see DescriptorAllocator
+    VkDescriptorSetLayoutCreateFlags layoutFlags = 0;
+    VkPipelineCreateFlags pipelineFlags = 0;
+    if (lveDevice->isPushDescriptorEnabled()) {
+        layoutFlags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+    } else if (lveDevice->isDescriptorBufferEnabled()) {
+        layoutFlags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+        pipelineFlags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
     }
+    VkDescriptorSetLayout descriptorSetLayout =
+        lveDevice->descriptorLayoutCache().getLayout(reflection.getBindings(0), layoutFlags);
 
     // pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -46,7 +82,110 @@ void createPipelines(VkDevice device, lve::LveSwapChain *swapChain,
 
     // push constants
     VkPushConstantRange pushConstant =
-        pushConstants<lve::TransparentPushConstants>(VK_SHADER_STAGE_VERTEX_BIT);
+        reflection.getPushConstantRange<lve::TransparentPushConstants>("TransparentPushConstants");
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstant;
+
+    VkPipelineLayout pipelineLayout;
+    if (vkCreatePipelineLayout(device, &pipelineLayoutInfo, nullptr, &pipelineLayout) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline layout!");
+    }
+
+    lve::PipelineBuilder pipelineBuilder;
+
+    pipelineBuilder.pipelineLayout = pipelineLayout;
+    pipelineBuilder.flags = pipelineFlags;
+    pipelineBuilder.setInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    pipelineBuilder.setPolygonMode(VK_POLYGON_MODE_FILL);
+    pipelineBuilder.setCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
+    pipelineBuilder.setMultisamplingNone();
+    setDynamicState(lveDevice, pipelineBuilder);
+    pipelineBuilder.setColorAttachmentFormat(swapChain->getSwapChainImageFormat());
+    pipelineBuilder.setDepthFormat(swapChain->getSwapChainDepthFormat());
+
+    // a stage only sees the features it declares, so variants share the modules of stages that
+    // compile the same
+    std::map<std::pair<std::string, std::vector<std::string>>, VkShaderModule> shaderModules;
+    shaderModules[{vertPath, vertDefines}] =
+        lve::PipelineBuilder::createShaderModule(device, vertCode);
+    shaderModules[{fragPath, fragDefines}] =
+        lve::PipelineBuilder::createShaderModule(device, fragCode);
+    auto getShaderModule = [&](const std::string &path, lve::ShaderFeatures features) {
+        std::vector<std::string> defines = permutations.getDefines(path, features);
+        auto [it, inserted] = shaderModules.try_emplace({path, defines}, VK_NULL_HANDLE);
+        if (inserted) {
+            it->second =
+                lve::PipelineBuilder::createShaderModule(device, shaders.compile(path, defines));
+        }
+        return it->second;
+    };
+
+    outPipelines->graphicsVariants.clear();
+    for (lve::ShaderFeatures features : variants) {
+        bool transparent = (features & lve::SHADER_FEATURE_ALPHA_BLEND) != 0;
+        VkShaderModule vertShaderModule = getShaderModule(vertPath, features);
+        VkShaderModule fragShaderModule = getShaderModule(fragPath, features);
+        pipelineBuilder.setShaders(vertShaderModule, fragShaderModule);
+        pipelineBuilder.setRenderState(transparent ? TRANSPARENT_STATE : OPAQUE_STATE);
+
+        lve::Pipeline variant;
+        variant.id = registry.getPipeline(pipelineBuilder);
+        variant.pipeline = registry.getHandle(variant.id);
+        variant.layout = pipelineLayout;
+        variant.descriptorSetLayout = descriptorSetLayout;
+        variant.shaderModules = {vertShaderModule, fragShaderModule};
+        variant.shaderSources = {vertPath, fragPath};
+        variant.renderState = transparent ? TRANSPARENT_STATE : OPAQUE_STATE;
+        variant.features = features;
+        variant.transparent = transparent;
+        outPipelines->graphicsVariants.push_back(variant);
+    }
+
+    // the first variant owns every module of the group
+    std::vector<VkShaderModule> &ownedModules = outPipelines->graphicsVariants[0].shaderModules;
+    ownedModules.clear();
+    for (const auto &[stage, shaderModule] : shaderModules) {
+        ownedModules.push_back(shaderModule);
+    }
+}
+
+void createBindlessPipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
+                             lve::ApplicationPipelines *outPipelines) {
+    VkDevice device = lveDevice->device();
+    lve::PipelineRegistry &registry = lveDevice->pipelineRegistry();
+    lve::ShaderCompiler &shaders = lveDevice->shaderCompiler();
+    uint32_t textureCount = lveDevice->getMaxBindlessTextures();
+
+    std::vector<uint32_t> vertCode = shaders.compile("shaders/bindless_shader.vert");
+    std::vector<uint32_t> fragCode = shaders.compile("shaders/bindless_shader.frag");
+    lve::ShaderReflection reflection{vertCode};
+    reflection.merge(lve::ShaderReflection{fragCode});
+
+    // one set per frame for the whole scene, the texture array is filled as textures are registered
+    std::vector<VkSampler> textureSamplers(textureCount, getTextureSampler(lveDevice));
+    reflection.setDescriptorCount(0, 1, textureCount);
+    reflection.setImmutableSamplers(0, 1, textureSamplers.data());
+
+    // binding 2 holds the requested mip level per texture, read back for texture streaming
+    std::vector<VkDescriptorBindingFlags> bindingFlags = {
+        0,
+        VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+            VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT,
+        0};
+    VkDescriptorSetLayout descriptorSetLayout = lveDevice->descriptorLayoutCache().getLayout(
+        reflection.getBindings(0), VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT,
+        bindingFlags);
+
+    // pipeline layout
+    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &descriptorSetLayout;
+
+    // push constants, the fragment stage reads the texture index
+    VkPushConstantRange pushConstant =
+        reflection.getPushConstantRange<lve::BindlessPushConstants>("BindlessPushConstants");
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstant;
 
@@ -59,60 +198,59 @@ void createPipelines(VkDevice device, lve::LveSwapChain *swapChain,
     lve::PipelineBuilder pipelineBuilder;
 
     pipelineBuilder.pipelineLayout = pipelineLayout;
-    VkShaderModule vertShaderModule =
-        lve::PipelineBuilder::createShaderModule(device, "shaders/simple_shader.vert.spv");
-    VkShaderModule fragShaderModule =
-        lve::PipelineBuilder::createShaderModule(device, "shaders/simple_shader.frag.spv");
+    VkShaderModule vertShaderModule = lve::PipelineBuilder::createShaderModule(device, vertCode);
+    VkShaderModule fragShaderModule = lve::PipelineBuilder::createShaderModule(device, fragCode);
     pipelineBuilder.setShaders(vertShaderModule, fragShaderModule);
     pipelineBuilder.setInputTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
     pipelineBuilder.setPolygonMode(VK_POLYGON_MODE_FILL);
     pipelineBuilder.setCullMode(VK_CULL_MODE_BACK_BIT, VK_FRONT_FACE_COUNTER_CLOCKWISE);
     pipelineBuilder.setMultisamplingNone();
-    pipelineBuilder.disableBlending();
-    pipelineBuilder.enableDepthTest();
+    setDynamicState(lveDevice, pipelineBuilder);
+    pipelineBuilder.setRenderState(OPAQUE_STATE);
     pipelineBuilder.setColorAttachmentFormat(swapChain->getSwapChainImageFormat());
     pipelineBuilder.setDepthFormat(swapChain->getSwapChainDepthFormat());
 
-    outPipelines->opaquePipeline.pipeline = pipelineBuilder.buildPipeline(device);
-    outPipelines->opaquePipeline.layout = pipelineLayout;
-    outPipelines->opaquePipeline.descriptorSetLayout = descriptorSetLayout;
-    outPipelines->opaquePipeline.shaderModules = {vertShaderModule, fragShaderModule};
-    outPipelines->opaquePipeline.transparent = false;
+    outPipelines->bindlessOpaquePipeline.id = registry.getPipeline(pipelineBuilder);
+    outPipelines->bindlessOpaquePipeline.pipeline =
+        registry.getHandle(outPipelines->bindlessOpaquePipeline.id);
+    outPipelines->bindlessOpaquePipeline.layout = pipelineLayout;
+    outPipelines->bindlessOpaquePipeline.descriptorSetLayout = descriptorSetLayout;
+    outPipelines->bindlessOpaquePipeline.shaderModules = {vertShaderModule, fragShaderModule};
+    outPipelines->bindlessOpaquePipeline.shaderSources = {
+        "shaders/bindless_shader.vert", "shaders/bindless_shader.frag"};
+    outPipelines->bindlessOpaquePipeline.renderState = OPAQUE_STATE;
+    outPipelines->bindlessOpaquePipeline.transparent = false;
 
     // transparent pipeline
-    pipelineBuilder.pipelineLayout = pipelineLayout;
-    pipelineBuilder.setCullMode(VK_CULL_MODE_NONE, VK_FRONT_FACE_COUNTER_CLOCKWISE);
-    pipelineBuilder.enableBlending();
-    pipelineBuilder.disableDepthTest();
-    outPipelines->transparentPipeline.pipeline = pipelineBuilder.buildPipeline(device);
-    outPipelines->transparentPipeline.layout = pipelineLayout;
-    outPipelines->transparentPipeline.descriptorSetLayout = descriptorSetLayout;
-    outPipelines->transparentPipeline.shaderModules = {vertShaderModule, fragShaderModule};
-    outPipelines->transparentPipeline.transparent = true;
+    pipelineBuilder.setRenderState(TRANSPARENT_STATE);
+    outPipelines->bindlessTransparentPipeline.id = registry.getPipeline(pipelineBuilder);
+    outPipelines->bindlessTransparentPipeline.pipeline =
+        registry.getHandle(outPipelines->bindlessTransparentPipeline.id);
+    outPipelines->bindlessTransparentPipeline.layout = pipelineLayout;
+    outPipelines->bindlessTransparentPipeline.descriptorSetLayout = descriptorSetLayout;
+    outPipelines->bindlessTransparentPipeline.shaderModules = {vertShaderModule, fragShaderModule};
+    outPipelines->bindlessTransparentPipeline.shaderSources = {
+        "shaders/bindless_shader.vert", "shaders/bindless_shader.frag"};
+    outPipelines->bindlessTransparentPipeline.renderState = TRANSPARENT_STATE;
+    outPipelines->bindlessTransparentPipeline.transparent = true;
 }
 
-void createComputePipelines(VkDevice device, lve::LveSwapChain *swapChain,
+void createComputePipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
                             lve::ApplicationPipelines *outPipelines) {
+    VkDevice device = lveDevice->device();
+    lve::PipelineRegistry &registry = lveDevice->pipelineRegistry();
+    lve::ShaderCompiler &shaders = lveDevice->shaderCompiler();
+
+    std::vector<uint32_t> computeCode = shaders.compile("shaders/compute.comp");
+    lve::ShaderReflection reflection{computeCode};
+
     // descriptor sets
-    VkDescriptorSetLayoutBinding storageImageBinding{};
-    storageImageBinding.binding = 0;
-    storageImageBinding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-    storageImageBinding.descriptorCount = 1;
-    storageImageBinding.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
-    storageImageBinding.pImmutableSamplers = nullptr;
-
-    std::array<VkDescriptorSetLayoutBinding, 1> bindings = {storageImageBinding};
-
-    VkDescriptorSetLayoutCreateInfo layoutInfo{};
-    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
-    layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
-    layoutInfo.pBindings = bindings.data();
-
-    VkDescriptorSetLayout descriptorSetLayout;
-    if (vkCreateDescriptorSetLayout(device, &layoutInfo, nullptr, &descriptorSetLayout) !=
-        VK_SUCCESS) {
-        throw std::runtime_error("failed to create descriptor set layout!");
+    VkDescriptorSetLayoutCreateFlags layoutFlags = 0;
+    if (lveDevice->isDescriptorBufferEnabled()) {
+        layoutFlags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
     }
+    VkDescriptorSetLayout descriptorSetLayout =
+        lveDevice->descriptorLayoutCache().getLayout(reflection.getBindings(0), layoutFlags);
 
     // pipeline layout
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
@@ -122,7 +260,7 @@ void createComputePipelines(VkDevice device, lve::LveSwapChain *swapChain,
 
     // push constants
     VkPushConstantRange pushConstant =
-        pushConstants<lve::PerlinPushConstants>(VK_SHADER_STAGE_COMPUTE_BIT);
+        reflection.getPushConstantRange<lve::PerlinPushConstants>("PerlinPushConstants");
     pipelineLayoutInfo.pushConstantRangeCount = 1;
     pipelineLayoutInfo.pPushConstantRanges = &pushConstant;
 
@@ -132,17 +270,70 @@ void createComputePipelines(VkDevice device, lve::LveSwapChain *swapChain,
         throw std::runtime_error("failed to create pipeline layout!");
     }
 
+    lve::Pipeline &perlinNoisePipeline = outPipelines->computePipelines.perlinNoisePipeline;
+    perlinNoisePipeline.layout = pipelineLayout;
+    perlinNoisePipeline.descriptorSetLayout = descriptorSetLayout;
+    perlinNoisePipeline.shaderModules = {
+        lve::PipelineBuilder::createShaderModule(device, computeCode)};
+    perlinNoisePipeline.shaderSources = {"shaders/compute.comp"};
+    perlinNoisePipeline.transparent = false;
+
+    // one invocation per swap chain pixel
+    lve::PerlinSpecialization &specialization =
+        outPipelines->computePipelines.perlinNoiseSpecialization;
+    VkExtent2D workgroupSize = chooseWorkgroupSize(lveDevice);
+    specialization.workgroupWidth = workgroupSize.width;
+    specialization.workgroupHeight = workgroupSize.height;
+    specialization.width = swapChain->getSwapChainExtent().width;
+    specialization.height = swapChain->getSwapChainExtent().height;
+    perlinNoisePipeline.id =
+        specializePerlinNoisePipeline(lveDevice, perlinNoisePipeline, specialization);
+    perlinNoisePipeline.pipeline = registry.getHandle(perlinNoisePipeline.id);
+}
+
+lve::PipelineId specializePerlinNoisePipeline(lve::LveDevice *lveDevice,
+                                              const lve::Pipeline &perlinNoisePipeline,
+                                              const lve::PerlinSpecialization &specialization) {
+    std::array<VkSpecializationMapEntry, 4> mapEntries = lve::PerlinSpecialization::mapEntries();
+    VkSpecializationInfo specializationInfo{};
+    specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+    specializationInfo.pMapEntries = mapEntries.data();
+    specializationInfo.dataSize = sizeof(specialization);
+    specializationInfo.pData = &specialization;
+
     lve::PipelineBuilder pipelineBuilder;
-    pipelineBuilder.pipelineLayout = pipelineLayout;
-    VkShaderModule computeShaderModule =
-        lve::PipelineBuilder::createShaderModule(device, "shaders/compute.comp.spv");
-    pipelineBuilder.setComputeShader(computeShaderModule);
-
-    outPipelines->computePipelines.perlinNoisePipeline.pipeline =
-        pipelineBuilder.buildComputePipeline(device);
-    outPipelines->computePipelines.perlinNoisePipeline.layout = pipelineLayout;
-    outPipelines->computePipelines.perlinNoisePipeline.descriptorSetLayout = descriptorSetLayout;
-    outPipelines->computePipelines.perlinNoisePipeline.shaderModules = {computeShaderModule};
-    outPipelines->computePipelines.perlinNoisePipeline.transparent = false;
+    pipelineBuilder.pipelineLayout = perlinNoisePipeline.layout;
+    if (lveDevice->isDescriptorBufferEnabled()) {
+        pipelineBuilder.flags = VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT;
+    }
+    pipelineBuilder.setComputeShader(perlinNoisePipeline.shaderModules[0], &specializationInfo);
+    return lveDevice->pipelineRegistry().getPipeline(pipelineBuilder);
+}
+
+VkExtent2D chooseWorkgroupSize(lve::LveDevice *lveDevice) {
+    // a subgroup wide row, so a subgroup writes neighbouring pixels, and as many rows as fit in
+    // 256 invocations
+    const VkPhysicalDeviceLimits &limits = lveDevice->properties.limits;
+    uint32_t invocations = std::min(256u, limits.maxComputeWorkGroupInvocations);
+    uint32_t width = std::min(
+        {lveDevice->getSubgroupSize(), limits.maxComputeWorkGroupSize[0], invocations});
+    width = std::max(width, 1u);
+    uint32_t height = std::clamp(invocations / width, 1u, limits.maxComputeWorkGroupSize[1]);
+    return {width, height};
+}
+
+void createPipelineGroup(lve::PipelineGroup group, lve::LveDevice *lveDevice,
+                         lve::LveSwapChain *swapChain, lve::ApplicationPipelines *outPipelines) {
+    switch (group) {
+    case lve::PipelineGroup::Graphics:
+        createPipelines(lveDevice, swapChain, outPipelines);
+        break;
+    case lve::PipelineGroup::Bindless:
+        createBindlessPipelines(lveDevice, swapChain, outPipelines);
+        break;
+    case lve::PipelineGroup::Compute:
+        createComputePipelines(lveDevice, swapChain, outPipelines);
+        break;
+    }
 }
 } // namespace init
\ No newline at end of file
@@ -1,12 +1,25 @@
 #pragma once
 
+#include "../lve_device.hpp"
 #include "../lve_swap_chain.hpp"
 #include "../lve_types.hpp"
 #include "../pipeline_builder.hpp"
+#include "../pipeline_compiler.hpp"
 
 namespace init {
-void createPipelines(VkDevice device, lve::LveSwapChain *swapChain,
+void createPipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
                      lve::ApplicationPipelines *outPipelines);
-void createComputePipelines(VkDevice device, lve::LveSwapChain *swapChain,
+void createBindlessPipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
+                             lve::ApplicationPipelines *outPipelines);
+void createComputePipelines(lve::LveDevice *lveDevice, lve::LveSwapChain *swapChain,
                             lve::ApplicationPipelines *outPipelines);
+// the perlin noise pipeline createComputePipelines built, with other specialization constants
+lve::PipelineId specializePerlinNoisePipeline(lve::LveDevice *lveDevice,
+                                              const lve::Pipeline &perlinNoisePipeline,
+                                              const lve::PerlinSpecialization &specialization);
+// the default compute workgroup for the device's subgroup size and limits
+VkExtent2D chooseWorkgroupSize(lve::LveDevice *lveDevice);
+// calls the create function of the group, only that group's members of outPipelines are written
+void createPipelineGroup(lve::PipelineGroup group, lve::LveDevice *lveDevice,
+                         lve::LveSwapChain *swapChain, lve::ApplicationPipelines *outPipelines);
 } // namespace init
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "lve_device.hpp"
 
 // std headers
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <set>
@@ -41,16 +42,40 @@ void DestroyDebugUtilsMessengerEXT(VkInstance instance, VkDebugUtilsMessengerEXT
 }
 
 // class member functions
-LveDevice::LveDevice(LveWindow &window) : window{window} {
+LveDevice::LveDevice(LveWindow &window, uint32_t framesInFlight)
+    : window{window}, framesInFlight{framesInFlight} {
+    if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT) {
+        throw std::runtime_error("failed to create device, frames in flight must be 1 to " +
+                                 std::to_string(MAX_FRAMES_IN_FLIGHT));
+    }
     createInstance();
     setupDebugMessenger();
     createSurface();
     pickPhysicalDevice();
     createLogicalDevice();
     createCommandPool();
+    samplerCache_ = std::make_unique<SamplerCache>(device_);
+    descriptorLayoutCache_ = std::make_unique<DescriptorLayoutCache>(device_);
+    descriptorTemplateCache_ = std::make_unique<DescriptorTemplateCache>(device_);
+    if (descriptorBufferEnabled) {
+        descriptorBuffer_ = std::make_unique<DescriptorBuffer>(*this);
+    }
+    dynamicState_ =
+        std::make_unique<DynamicState>(device_, extendedDynamicStateEnabled, dynamicBlendEnabled);
+    pipelineCache_ = std::make_unique<PipelineCache>(device_, properties, PIPELINE_CACHE_PATH);
+    pipelineRegistry_ = std::make_unique<PipelineRegistry>(*this);
+    shaderCompiler_ = std::make_unique<ShaderCompiler>(SHADER_CACHE_DIRECTORY);
 }
 
 LveDevice::~LveDevice() {
+    shaderCompiler_.reset();
+    pipelineRegistry_.reset();
+    pipelineCache_.reset();
+    dynamicState_.reset();
+    descriptorBuffer_.reset();
+    descriptorTemplateCache_.reset();
+    descriptorLayoutCache_.reset();
+    samplerCache_.reset();
     vkDestroyCommandPool(device_, commandPool, nullptr);
     vkDestroyDevice(device_, nullptr);
 
@@ -143,13 +168,168 @@ void LveDevice::createLogicalDevice() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice_, &supportedFeatures);
+
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    // optional, cooked BC textures fall back to their source images without it
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    // bindless shaders write texture streaming feedback
+    deviceFeatures.fragmentStoresAndAtomics = supportedFeatures.fragmentStoresAndAtomics;
 
     VkPhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeature{
         .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES};
     dynamicRenderingFeature.dynamicRendering = VK_TRUE;
-    dynamicRenderingFeature.pNext = nullptr;
+
+    // optional, descriptor indexing for the bindless texture path
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT supportedDescriptorBufferFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT};
+    VkPhysicalDeviceVulkan12Features supportedFeatures12{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    bool descriptorBufferExtension =
+        hasDeviceExtension(physicalDevice_, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    if (descriptorBufferExtension) {
+        supportedFeatures12.pNext = &supportedDescriptorBufferFeatures;
+    }
+    // cull mode, depth state and blend enable are set per draw batch, so pipelines that differ only
+    // in those collapse into one. Cull mode and depth state are core in Vulkan 1.3, blend enable is
+    // optional
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT supportedDynamicState3Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT};
+    bool dynamicState3Extension = false;
+#ifndef LVE_DISABLE_DYNAMIC_STATE
+    extendedDynamicStateEnabled = true;
+    dynamicState3Extension =
+        hasDeviceExtension(physicalDevice_, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+#endif
+    if (dynamicState3Extension) {
+        supportedDynamicState3Features.pNext = supportedFeatures12.pNext;
+        supportedFeatures12.pNext = &supportedDynamicState3Features;
+    }
+    // optional, graphics pipelines are linked from separately compiled parts, see PipelineRegistry
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT supportedPipelineLibraryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+    bool pipelineLibraryExtension = false;
+#ifndef LVE_DISABLE_PIPELINE_LIBRARIES
+    pipelineLibraryExtension =
+        hasDeviceExtension(physicalDevice_, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) &&
+        hasDeviceExtension(physicalDevice_, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+#endif
+    if (pipelineLibraryExtension) {
+        supportedPipelineLibraryFeatures.pNext = supportedFeatures12.pNext;
+        supportedFeatures12.pNext = &supportedPipelineLibraryFeatures;
+    }
+    // optional, the frame pacer waits for presents to sample input close to scanout, see FramePacer
+    VkPhysicalDevicePresentIdFeaturesKHR supportedPresentIdFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR};
+    VkPhysicalDevicePresentWaitFeaturesKHR supportedPresentWaitFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+    bool presentWaitExtension = false;
+#ifndef LVE_DISABLE_PRESENT_WAIT
+    presentWaitExtension =
+        hasDeviceExtension(physicalDevice_, VK_KHR_PRESENT_ID_EXTENSION_NAME) &&
+        hasDeviceExtension(physicalDevice_, VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+#endif
+    if (presentWaitExtension) {
+        supportedPresentIdFeatures.pNext = supportedFeatures12.pNext;
+        supportedPresentWaitFeatures.pNext = &supportedPresentIdFeatures;
+        supportedFeatures12.pNext = &supportedPresentWaitFeatures;
+    }
+    VkPhysicalDeviceFeatures2 supportedFeatures2{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+                                                 .pNext = &supportedFeatures12};
+    vkGetPhysicalDeviceFeatures2(physicalDevice_, &supportedFeatures2);
+    bindlessSupported = supportedFeatures.fragmentStoresAndAtomics &&
+                        supportedFeatures12.runtimeDescriptorArray &&
+                        supportedFeatures12.descriptorBindingPartiallyBound &&
+                        supportedFeatures12.descriptorBindingSampledImageUpdateAfterBind &&
+                        supportedFeatures12.descriptorBindingUpdateUnusedWhilePending;
+
+    VkPhysicalDeviceVulkan11Properties properties11{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES};
+    VkPhysicalDeviceVulkan12Properties properties12{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES, .pNext = &properties11};
+    VkPhysicalDeviceProperties2 properties2{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2,
+                                            .pNext = &properties12};
+    vkGetPhysicalDeviceProperties2(physicalDevice_, &properties2);
+    // combined image samplers count against both the image and the sampler limits
+    maxBindlessTextures = std::min({MAX_BINDLESS_TEXTURES,
+                                    properties12.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                    properties12.maxPerStageDescriptorUpdateAfterBindSamplers,
+                                    properties12.maxDescriptorSetUpdateAfterBindSampledImages,
+                                    properties12.maxDescriptorSetUpdateAfterBindSamplers});
+    subgroupSize = properties11.subgroupSize;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES};
+    vulkan12Features.runtimeDescriptorArray = bindlessSupported;
+    vulkan12Features.descriptorBindingPartiallyBound = bindlessSupported;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = bindlessSupported;
+    vulkan12Features.descriptorBindingUpdateUnusedWhilePending = bindlessSupported;
+    // core since 1.2, frames in flight are tracked by one timeline semaphore
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    dynamicRenderingFeature.pNext = &vulkan12Features;
+
+    // optional, non-bindless descriptor sets are written straight into a descriptor buffer,
+    // otherwise they come from descriptor pools
+    std::vector<const char *> enabledExtensions = deviceExtensions;
+    descriptorBufferEnabled = descriptorBufferExtension &&
+                              supportedDescriptorBufferFeatures.descriptorBuffer &&
+                              supportedFeatures12.bufferDeviceAddress;
+    VkPhysicalDeviceDescriptorBufferFeaturesEXT descriptorBufferFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT};
+    if (descriptorBufferEnabled) {
+        descriptorBufferFeatures.descriptorBuffer = VK_TRUE;
+        vulkan12Features.bufferDeviceAddress = VK_TRUE;
+        vulkan12Features.pNext = &descriptorBufferFeatures;
+        enabledExtensions.push_back(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME);
+    }
+
+    // optional, per model descriptors are pushed at draw time instead of kept in sets
+#ifndef LVE_DISABLE_PUSH_DESCRIPTORS
+    pushDescriptorEnabled = hasDeviceExtension(physicalDevice_, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+#endif
+    if (pushDescriptorEnabled) {
+        enabledExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    }
+
+    dynamicBlendEnabled = dynamicState3Extension &&
+                          supportedDynamicState3Features.extendedDynamicState3ColorBlendEnable;
+    VkPhysicalDeviceExtendedDynamicState3FeaturesEXT dynamicState3Features{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT};
+    if (dynamicBlendEnabled) {
+        dynamicState3Features.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+        dynamicState3Features.pNext = vulkan12Features.pNext;
+        vulkan12Features.pNext = &dynamicState3Features;
+        enabledExtensions.push_back(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+    }
+    graphicsPipelineLibraryEnabled =
+        pipelineLibraryExtension && supportedPipelineLibraryFeatures.graphicsPipelineLibrary;
+    VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT pipelineLibraryFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT};
+    if (graphicsPipelineLibraryEnabled) {
+        pipelineLibraryFeatures.graphicsPipelineLibrary = VK_TRUE;
+        pipelineLibraryFeatures.pNext = vulkan12Features.pNext;
+        vulkan12Features.pNext = &pipelineLibraryFeatures;
+        enabledExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+    }
+
+    presentWaitEnabled = presentWaitExtension && supportedPresentIdFeatures.presentId &&
+                         supportedPresentWaitFeatures.presentWait;
+    VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR};
+    VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{
+        .sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR};
+    if (presentWaitEnabled) {
+        presentIdFeatures.presentId = VK_TRUE;
+        presentWaitFeatures.presentWait = VK_TRUE;
+        presentIdFeatures.pNext = vulkan12Features.pNext;
+        presentWaitFeatures.pNext = &presentIdFeatures;
+        vulkan12Features.pNext = &presentWaitFeatures;
+        enabledExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+        enabledExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    }
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -159,8 +339,8 @@ void LveDevice::createLogicalDevice() {
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
 
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-    createInfo.ppEnabledExtensionNames = deviceExtensions.data();
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
 
     // might not really be necessary anymore because device specific validation layers
     // have been deprecated
@@ -316,6 +496,22 @@ bool LveDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
     return requiredExtensions.empty();
 }
 
+bool LveDevice::hasDeviceExtension(VkPhysicalDevice device, const char *extensionName) {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount,
+                                         availableExtensions.data());
+
+    for (const auto &extension : availableExtensions) {
+        if (strcmp(extension.extensionName, extensionName) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 QueueFamilyIndices LveDevice::findQueueFamilies(VkPhysicalDevice device) {
     QueueFamilyIndices indices;
 
@@ -388,6 +584,17 @@ VkFormat LveDevice::findSupportedFormat(const std::vector<VkFormat> &candidates,
     throw std::runtime_error("failed to find supported format!");
 }
 
+bool LveDevice::isFormatSupported(VkFormat format, VkImageTiling tiling,
+                                  VkFormatFeatureFlags features) {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice_, format, &props);
+
+    VkFormatFeatureFlags supported = tiling == VK_IMAGE_TILING_LINEAR
+                                         ? props.linearTilingFeatures
+                                         : props.optimalTilingFeatures;
+    return (supported & features) == features;
+}
+
 uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) {
     VkPhysicalDeviceMemoryProperties memProperties;
     vkGetPhysicalDeviceMemoryProperties(physicalDevice_, &memProperties);
@@ -404,6 +611,12 @@ uint32_t LveDevice::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags pr
 void LveDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
                              VkMemoryPropertyFlags properties, VkBuffer &buffer,
                              VkDeviceMemory &bufferMemory) {
+    // descriptor buffers reference uniform and storage buffers by their device address
+    if (descriptorBufferEnabled &&
+        (usage & (VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT))) {
+        usage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+    }
+
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
@@ -422,6 +635,13 @@ void LveDevice::createBuffer(VkDeviceSize size, VkBufferUsageFlags usage,
     allocInfo.allocationSize = memRequirements.size;
     allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
+    VkMemoryAllocateFlagsInfo allocFlagsInfo{};
+    allocFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    allocFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+    if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) {
+        allocInfo.pNext = &allocFlagsInfo;
+    }
+
     if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
         throw std::runtime_error("failed to allocate vertex buffer memory!");
     }
@@ -495,7 +715,7 @@ void LveDevice::copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width
     endSingleTimeCommands(commandBuffer);
 }
 
-VkImageView LveDevice::createImageView(VkImage image, VkFormat format) {
+VkImageView LveDevice::createImageView(VkImage image, VkFormat format, uint32_t mipLevels) {
     VkImageViewCreateInfo viewInfo{};
     viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
     viewInfo.image = image;
@@ -503,7 +723,7 @@ VkImageView LveDevice::createImageView(VkImage image, VkFormat format) {
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.levelCount = mipLevels;
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = 1;
 
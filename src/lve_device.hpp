@@ -1,8 +1,17 @@
 #pragma once
 
 #include "lve_window.hpp"
+#include "descriptor_buffer.hpp"
+#include "descriptor_layout_cache.hpp"
+#include "descriptor_template_cache.hpp"
+#include "dynamic_state.hpp"
+#include "pipeline_cache.hpp"
+#include "pipeline_registry.hpp"
+#include "sampler_cache.hpp"
+#include "shader_compiler.hpp"
 
 // std lib headers
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -29,8 +38,13 @@ public:
 #else
     const bool enableValidationLayers = true;
 #endif
+    static constexpr uint32_t MAX_BINDLESS_TEXTURES = 1024;
+    // more frames in flight trade latency for throughput, per-frame resources are sized to the
+    // count chosen at construction
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+    static constexpr uint32_t DEFAULT_FRAMES_IN_FLIGHT = 2;
 
-    LveDevice(LveWindow &window);
+    LveDevice(LveWindow &window, uint32_t framesInFlight = DEFAULT_FRAMES_IN_FLIGHT);
     ~LveDevice();
 
     // Not copyable or movable
@@ -46,12 +60,30 @@ public:
     VkSurfaceKHR surface() { return surface_; }
     VkQueue graphicsQueue() { return graphicsQueue_; }
     VkQueue presentQueue() { return presentQueue_; }
+    SamplerCache &samplerCache() { return *samplerCache_; }
+    DescriptorLayoutCache &descriptorLayoutCache() { return *descriptorLayoutCache_; }
+    DescriptorTemplateCache &descriptorTemplateCache() { return *descriptorTemplateCache_; }
+    // only valid while isDescriptorBufferEnabled()
+    DescriptorBuffer &descriptorBuffer() { return *descriptorBuffer_; }
+    DynamicState &dynamicState() { return *dynamicState_; }
+    PipelineCache &pipelineCache() { return *pipelineCache_; }
+    PipelineRegistry &pipelineRegistry() { return *pipelineRegistry_; }
+    ShaderCompiler &shaderCompiler() { return *shaderCompiler_; }
+    bool isBindlessSupported() { return bindlessSupported; }
+    bool isDescriptorBufferEnabled() { return descriptorBufferEnabled; }
+    bool isPushDescriptorEnabled() { return pushDescriptorEnabled; }
+    bool isGraphicsPipelineLibraryEnabled() { return graphicsPipelineLibraryEnabled; }
+    bool isPresentWaitEnabled() { return presentWaitEnabled; }
+    uint32_t getMaxBindlessTextures() { return maxBindlessTextures; }
+    uint32_t getSubgroupSize() { return subgroupSize; }
+    uint32_t getFramesInFlight() { return framesInFlight; }
 
     SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice_); }
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice_); }
     VkFormat findSupportedFormat(const std::vector<VkFormat> &candidates, VkImageTiling tiling,
                                  VkFormatFeatureFlags features);
+    bool isFormatSupported(VkFormat format, VkImageTiling tiling, VkFormatFeatureFlags features);
 
     // Buffer Helper Functions
     void createBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
@@ -61,7 +93,7 @@ public:
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
     void copyBufferToImage(VkBuffer buffer, VkImage image, uint32_t width, uint32_t height,
                            uint32_t layerCount);
-    VkImageView createImageView(VkImage image, VkFormat format);
+    VkImageView createImageView(VkImage image, VkFormat format, uint32_t mipLevels = 1);
 
     void createImageWithInfo(const VkImageCreateInfo &imageInfo, VkMemoryPropertyFlags properties,
                              VkImage &image, VkDeviceMemory &imageMemory);
@@ -84,11 +116,22 @@ private:
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void hasGflwRequiredInstanceExtensions();
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool hasDeviceExtension(VkPhysicalDevice device, const char *extensionName);
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
     VkDebugUtilsMessengerEXT debugMessenger;
     LveWindow &window;
+    uint32_t framesInFlight;
     VkCommandPool commandPool;
+    bool bindlessSupported = false;
+    uint32_t maxBindlessTextures = 0;
+    uint32_t subgroupSize = 1;
+    bool descriptorBufferEnabled = false;
+    bool pushDescriptorEnabled = false;
+    bool extendedDynamicStateEnabled = false;
+    bool dynamicBlendEnabled = false;
+    bool graphicsPipelineLibraryEnabled = false;
+    bool presentWaitEnabled = false;
 
     VkPhysicalDevice physicalDevice_ = VK_NULL_HANDLE;
     VkInstance instance_;
@@ -96,7 +139,17 @@ private:
     VkSurfaceKHR surface_;
     VkQueue graphicsQueue_;
     VkQueue presentQueue_;
-
+    std::unique_ptr<SamplerCache> samplerCache_;
+    std::unique_ptr<DescriptorLayoutCache> descriptorLayoutCache_;
+    std::unique_ptr<DescriptorTemplateCache> descriptorTemplateCache_;
+    std::unique_ptr<DescriptorBuffer> descriptorBuffer_;
+    std::unique_ptr<DynamicState> dynamicState_;
+    std::unique_ptr<PipelineCache> pipelineCache_;
+    std::unique_ptr<PipelineRegistry> pipelineRegistry_;
+    std::unique_ptr<ShaderCompiler> shaderCompiler_;
+
+    const std::string PIPELINE_CACHE_PATH = "pipeline_cache.bin";
+    const std::string SHADER_CACHE_DIRECTORY = "shaders/cache";
     const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
     const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME,
                                                         VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME};
@@ -12,14 +12,18 @@
 
 namespace lve {
 
-LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent)
-    : device{deviceRef}, windowExtent{extent} {
+LveSwapChain::LveSwapChain(LveDevice &deviceRef, VkExtent2D extent, VkPresentModeKHR presentMode)
+    : device{deviceRef}, windowExtent{extent}, presentMode{presentMode} {
     createSwapChain();
     createImageViews();
     createRenderPass();
     createDepthResources();
     createFramebuffers();
     createSyncObjects();
+    if (device.isPresentWaitEnabled()) {
+        vkWaitForPresent = reinterpret_cast<PFN_vkWaitForPresentKHR>(
+            vkGetDeviceProcAddr(device.device(), "vkWaitForPresentKHR"));
+    }
 }
 
 LveSwapChain::~LveSwapChain() {
@@ -46,52 +50,61 @@ LveSwapChain::~LveSwapChain() {
     vkDestroyRenderPass(device.device(), renderPass, nullptr);
 
     // cleanup synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
-        vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-        vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+    for (const FrameContext &frame : frames) {
+        vkDestroySemaphore(device.device(), frame.imageAvailable, nullptr);
+    }
+    for (VkSemaphore semaphore : renderFinished) {
+        vkDestroySemaphore(device.device(), semaphore, nullptr);
     }
+    vkDestroySemaphore(device.device(), frameTimeline, nullptr);
 
     vkDestroyFence(device.device(), immFence, nullptr);
 }
 
 VkResult LveSwapChain::acquireNextImage(uint32_t *imageIndex) {
-    vkWaitForFences(device.device(), 1, &inFlightFences[currentFrame], VK_TRUE,
-                    std::numeric_limits<uint64_t>::max());
+    FrameContext &frame = frames[currentFrame];
+
+    // a context that was never submitted waits for 0, which the timeline starts at
+    VkSemaphoreWaitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO};
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &frameTimeline;
+    waitInfo.pValues = &frame.timelineValue;
+    if (vkWaitSemaphores(device.device(), &waitInfo, std::numeric_limits<uint64_t>::max()) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to wait for frame timeline");
+    }
 
     VkResult result = vkAcquireNextImageKHR(
         device.device(), swapChain, std::numeric_limits<uint64_t>::max(),
-        imageAvailableSemaphores[currentFrame], // must be a not signaled semaphore
+        frame.imageAvailable, // must be a not signaled semaphore
         VK_NULL_HANDLE, imageIndex);
 
     return result;
 }
 
 VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) {
-    /*if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-      vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-    }*/
-    imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
-
-    VkSubmitInfo submitInfo = {};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
-
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = buffers;
-
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
-    submitInfo.pSignalSemaphores = signalSemaphores;
-
-    vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
-        VK_SUCCESS) {
+    FrameContext &frame = frames[currentFrame];
+    frame.timelineValue = ++frameNumber;
+
+    VkSemaphoreSubmitInfo waitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                                   .semaphore = frame.imageAvailable,
+                                   .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT};
+    // presentation can only wait on the binary semaphore, the timeline tracks the frame ring
+    std::array<VkSemaphoreSubmitInfo, 2> signalInfos = {
+        VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                              .semaphore = renderFinished[*imageIndex],
+                              .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT},
+        VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO,
+                              .semaphore = frameTimeline,
+                              .value = frame.timelineValue,
+                              .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT}};
+
+    VkCommandBufferSubmitInfo cmdInfo = init::commandBufferSubmitInfo(*buffers);
+    VkSubmitInfo2 submitInfo = init::submitInfo(&cmdInfo, nullptr, &waitInfo);
+    submitInfo.signalSemaphoreInfoCount = static_cast<uint32_t>(signalInfos.size());
+    submitInfo.pSignalSemaphoreInfos = signalInfos.data();
+
+    if (vkQueueSubmit2(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
         throw std::runtime_error("failed to submit draw command buffer!");
     }
 
@@ -99,7 +112,7 @@ VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 
     presentInfo.waitSemaphoreCount = 1;
-    presentInfo.pWaitSemaphores = signalSemaphores;
+    presentInfo.pWaitSemaphores = &renderFinished[*imageIndex];
 
     VkSwapchainKHR swapChains[] = {swapChain};
     presentInfo.swapchainCount = 1;
@@ -107,17 +120,26 @@ VkResult LveSwapChain::submitCommandBuffers(const VkCommandBuffer *buffers, uint
 
     presentInfo.pImageIndices = imageIndex;
 
+    // the timeline value doubles as present id, both increase by one per frame
+    VkPresentIdKHR presentId{.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR};
+    presentId.swapchainCount = 1;
+    presentId.pPresentIds = &frame.timelineValue;
+    if (device.isPresentWaitEnabled()) {
+        presentInfo.pNext = &presentId;
+    }
+
     auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % frames.size();
 
     return result;
 }
 
-void LveSwapChain::waitForFrameFence(uint32_t *imageIndex) {
-    if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE) {
-        vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
+VkResult LveSwapChain::waitForPresent(uint64_t presentId, uint64_t timeout) {
+    if (vkWaitForPresent == nullptr) {
+        throw std::runtime_error("failed to wait for present, VK_KHR_present_wait is not enabled");
     }
+    return vkWaitForPresent(device.device(), swapChain, presentId, timeout);
 }
 
 void LveSwapChain::immediateSubmitCommandBuffers(
@@ -158,7 +180,7 @@ void LveSwapChain::createSwapChain() {
     SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    VkPresentModeKHR chosenPresentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
     uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
@@ -194,7 +216,7 @@ void LveSwapChain::createSwapChain() {
     createInfo.preTransform = swapChainSupport.capabilities.currentTransform;
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
 
-    createInfo.presentMode = presentMode;
+    createInfo.presentMode = chosenPresentMode;
     createInfo.clipped = VK_TRUE;
 
     createInfo.oldSwapchain = VK_NULL_HANDLE;
@@ -213,6 +235,7 @@ void LveSwapChain::createSwapChain() {
 
     swapChainImageFormat = surfaceFormat.format;
     swapChainExtent = extent;
+    presentMode = chosenPresentMode;
 }
 
 void LveSwapChain::createImageViews() {
@@ -352,29 +375,39 @@ void LveSwapChain::createDepthResources() {
 }
 
 void LveSwapChain::createSyncObjects() {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+    frames.resize(device.getFramesInFlight());
 
     VkSemaphoreCreateInfo semaphoreInfo = {};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr,
-                              &imageAvailableSemaphores[i]) != VK_SUCCESS ||
-            vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr,
-                              &renderFinishedSemaphores[i]) != VK_SUCCESS ||
-            vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
+    for (FrameContext &frame : frames) {
+        if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &frame.imageAvailable) !=
+            VK_SUCCESS) {
             throw std::runtime_error("failed to create synchronization objects for a frame!");
         }
     }
+    renderFinished.resize(imageCount());
+    for (VkSemaphore &semaphore : renderFinished) {
+        if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create synchronization objects for an image!");
+        }
+    }
+
+    VkSemaphoreTypeCreateInfo timelineInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO};
+    timelineInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    timelineInfo.initialValue = 0;
+    VkSemaphoreCreateInfo timelineSemaphoreInfo = {};
+    timelineSemaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    timelineSemaphoreInfo.pNext = &timelineInfo;
+    if (vkCreateSemaphore(device.device(), &timelineSemaphoreInfo, nullptr, &frameTimeline) !=
+        VK_SUCCESS) {
+        throw std::runtime_error("failed to create frame timeline semaphore");
+    }
 
     // for immediate submit
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
     if (vkCreateFence(device.device(), &fenceInfo, nullptr, &immFence) != VK_SUCCESS) {
         throw std::runtime_error("failed to create immediate submit fence");
     }
@@ -395,20 +428,14 @@ LveSwapChain::chooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR> &ava
 VkPresentModeKHR
 LveSwapChain::chooseSwapPresentMode(const std::vector<VkPresentModeKHR> &availablePresentModes) {
     for (const auto &availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-            std::cout << "Present mode: Mailbox" << std::endl;
+        if (availablePresentMode == presentMode) {
+            std::cout << "Present mode: " << getPresentModeName(presentMode) << std::endl;
             return availablePresentMode;
         }
     }
 
-    // for (const auto &availablePresentMode : availablePresentModes) {
-    //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-    //     std::cout << "Present mode: Immediate" << std::endl;
-    //     return availablePresentMode;
-    //   }
-    // }
-
-    std::cout << "Present mode: V-Sync" << std::endl;
+    std::cout << "Present mode: " << getPresentModeName(presentMode) << " is not supported, using "
+              << getPresentModeName(VK_PRESENT_MODE_FIFO_KHR) << std::endl;
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -428,6 +455,32 @@ VkExtent2D LveSwapChain::chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabi
     }
 }
 
+VkPresentModeKHR LveSwapChain::presentModeFromName(const std::string &name) {
+    for (VkPresentModeKHR mode :
+         {VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR, VK_PRESENT_MODE_MAILBOX_KHR,
+          VK_PRESENT_MODE_IMMEDIATE_KHR}) {
+        if (name == getPresentModeName(mode)) {
+            return mode;
+        }
+    }
+    throw std::runtime_error("unknown present mode: " + name);
+}
+
+const char *LveSwapChain::getPresentModeName(VkPresentModeKHR mode) {
+    switch (mode) {
+    case VK_PRESENT_MODE_FIFO_KHR:
+        return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+        return "fifo_relaxed";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+        return "mailbox";
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+        return "immediate";
+    default:
+        return "unknown";
+    }
+}
+
 VkFormat LveSwapChain::findDepthFormat() {
     return device.findSupportedFormat(
         {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
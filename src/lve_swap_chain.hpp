@@ -12,17 +12,24 @@
 
 namespace lve {
 
+// Frames are recorded into a ring of device.getFramesInFlight() frame contexts. One timeline
+// semaphore counts finished frames, a frame context is reused once the frame that last used it
+// has signalled its value. The semaphore presentation waits on belongs to the swap chain image
+// instead, the timeline does not say when the presentation engine is done with it, but the image
+// is only acquired again after that.
 class LveSwapChain {
 public:
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
-
-    LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent);
+    // falls back to FIFO, the only mode every device supports, when presentMode is not available
+    LveSwapChain(LveDevice &deviceRef, VkExtent2D windowExtent,
+                 VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR);
     ~LveSwapChain();
 
     LveSwapChain(const LveSwapChain &) = delete;
     void operator=(const LveSwapChain &) = delete;
 
+    // index into per-frame resources, below device.getFramesInFlight()
     size_t getCurrentFrame() { return currentFrame; }
+    uint32_t getFramesInFlight() { return static_cast<uint32_t>(frames.size()); }
     VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
     VkRenderPass getRenderPass() { return renderPass; }
     VkImageView getImageView(int index) { return swapChainImageViews[index]; }
@@ -33,6 +40,7 @@ public:
     VkFormat getSwapChainDepthFormat() { return swapChainDepthFormat; }
     VkFormat getSwapChainImageFormat() { return swapChainImageFormat; }
     VkExtent2D getSwapChainExtent() { return swapChainExtent; }
+    VkPresentModeKHR getPresentMode() { return presentMode; }
     uint32_t width() { return swapChainExtent.width; }
     uint32_t height() { return swapChainExtent.height; }
 
@@ -42,13 +50,27 @@ public:
     }
     VkFormat findDepthFormat();
 
+    // fifo, fifo_relaxed, mailbox or immediate
+    static VkPresentModeKHR presentModeFromName(const std::string &name);
+    static const char *getPresentModeName(VkPresentModeKHR mode);
+
+    // waits until the current frame context is no longer in use by the GPU
     VkResult acquireNextImage(uint32_t *imageIndex);
     VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
-    void waitForFrameFence(uint32_t *imageIndex);
+    // id of the last present, with device.isPresentWaitEnabled() it can be waited for
+    uint64_t getPresentId() { return frameNumber; }
+    // VK_SUCCESS once presentId or a later present is on screen, VK_TIMEOUT before
+    VkResult waitForPresent(uint64_t presentId, uint64_t timeout);
     void immediateSubmitCommandBuffers(const VkCommandBuffer buffer,
                                        std::function<void(VkCommandBuffer cmd)> &&function);
 
 private:
+    struct FrameContext {
+        VkSemaphore imageAvailable;
+        // timeline value the frame last recorded with this context signals
+        uint64_t timelineValue = 0;
+    };
+
     void createSwapChain();
     void createImageViews();
     void createDepthResources();
@@ -80,11 +102,15 @@ private:
     VkExtent2D windowExtent;
 
     VkSwapchainKHR swapChain;
-
-    std::vector<VkSemaphore> imageAvailableSemaphores;
-    std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    std::vector<VkFence> imagesInFlight;
+    VkPresentModeKHR presentMode;
+    PFN_vkWaitForPresentKHR vkWaitForPresent = nullptr;
+
+    std::vector<FrameContext> frames;
+    // per swap chain image
+    std::vector<VkSemaphore> renderFinished;
+    VkSemaphore frameTimeline;
+    // frames submitted so far, the value the next frame signals is one more
+    uint64_t frameNumber = 0;
     size_t currentFrame = 0;
 
     VkFence immFence;
@@ -1,24 +1,42 @@
 #include "lve_types.hpp"
+#include "lve_device.hpp"
+
+// std
+#include <cstddef>
 
 namespace lve {
+std::array<VkSpecializationMapEntry, 4> PerlinSpecialization::mapEntries() {
+    return {{{0, offsetof(PerlinSpecialization, workgroupWidth), sizeof(uint32_t)},
+             {1, offsetof(PerlinSpecialization, workgroupHeight), sizeof(uint32_t)},
+             {2, offsetof(PerlinSpecialization, width), sizeof(uint32_t)},
+             {3, offsetof(PerlinSpecialization, height), sizeof(uint32_t)}}};
+}
+
 void destroyImage(VkDevice device, const AllocatedImage &img) {
     vkDestroyImageView(device, img.view, nullptr);
     vkDestroyImage(device, img.image, nullptr);
     vkFreeMemory(device, img.memory, nullptr);
 }
 
-void destroyApplicationPipelines(VkDevice device, const ApplicationPipelines &pipelines) {
-    destroyPipeline(device, pipelines.opaquePipeline);
-    vkDestroyPipeline(device, pipelines.transparentPipeline.pipeline, nullptr);
+void destroyApplicationPipelines(LveDevice &device, const ApplicationPipelines &pipelines) {
+    // graphics variants share the first one's layout and shaders, the bindless transparent pipeline
+    // the opaque one's
+    if (!pipelines.graphicsVariants.empty()) {
+        destroyPipeline(device, pipelines.graphicsVariants[0]);
+    }
+    if (pipelines.bindless) {
+        destroyPipeline(device, pipelines.bindlessOpaquePipeline);
+    }
     destroyPipeline(device, pipelines.computePipelines.perlinNoisePipeline);
 }
 
-void destroyPipeline(VkDevice device, const Pipeline &pipeline) {
-    vkDestroyPipeline(device, pipeline.pipeline, nullptr);
-    vkDestroyPipelineLayout(device, pipeline.layout, nullptr);
-    vkDestroyDescriptorSetLayout(device, pipeline.descriptorSetLayout, nullptr);
+void destroyPipeline(LveDevice &device, const Pipeline &pipeline) {
+    // a later layout may get the same handle, its templates must not be found for it
+    device.descriptorTemplateCache().evictLayout(pipeline.layout);
+    vkDestroyPipelineLayout(device.device(), pipeline.layout, nullptr);
+    // pipelines belong to the device's pipeline registry, descriptor set layouts to its layout cache
     for (VkShaderModule shader : pipeline.shaderModules) {
-        vkDestroyShaderModule(device, shader, nullptr);
+        vkDestroyShaderModule(device.device(), shader, nullptr);
     }
 }
 } // namespace lve
\ No newline at end of file
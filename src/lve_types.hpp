@@ -3,40 +3,114 @@
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
 #include <vector>
 
 namespace lve {
+class LveDevice;
+
 struct AllocatedImage {
     VkImage image;
     VkImageView view;
     VkDeviceMemory memory;
+    uint32_t mipLevels = 1;
+};
+
+// index of a pipeline in the device's PipelineRegistry
+using PipelineId = uint32_t;
+
+// feature keywords a shader can be compiled with, each is a define of the same name, see
+// ShaderPermutations
+enum ShaderFeature : uint32_t {
+    SHADER_FEATURE_TEXTURED = 1 << 0,
+    SHADER_FEATURE_ALPHA_BLEND = 1 << 1,
+    SHADER_FEATURE_VERTEX_COLOR = 1 << 2,
+    SHADER_FEATURE_INSTANCING = 1 << 3,
+    SHADER_FEATURE_SKINNING = 1 << 4,
+};
+using ShaderFeatures = uint32_t;
+
+// fixed function state a pipeline draws with. Baked into the pipeline, or set per draw batch by
+// DynamicState when the device supports extended dynamic state, so pipelines that differ only in it
+// collapse into one
+struct RenderState {
+    VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+    bool depthTest = true;
+    bool depthWrite = true;
+    VkCompareOp depthCompareOp = VK_COMPARE_OP_LESS;
+    // alpha blending, see PipelineBuilder::enableBlending
+    bool blend = false;
+
+    bool operator==(const RenderState &other) const = default;
 };
 
 struct Pipeline {
+    PipelineId id;
+    // owned by the PipelineRegistry, graphics pipelines are bound through getHandle(id) as the
+    // handle changes when an optimized link replaces the fast one
     VkPipeline pipeline;
     VkPipelineLayout layout;
     std::vector<VkShaderModule> shaderModules;
+    // the GLSL the modules were compiled from, watched for hot reload
+    std::vector<std::string> shaderSources;
     VkDescriptorSetLayout descriptorSetLayout;
+    RenderState renderState;
+    // the shader permutation it was built from
+    ShaderFeatures features = 0;
     bool transparent = false;
 
+    // transparent pipelines draw last
     bool operator<(const Pipeline &other) const {
-        return pipeline < other.pipeline && transparent <= other.transparent;
+        if (transparent != other.transparent) {
+            return other.transparent;
+        }
+        return id < other.id;
     }
 };
 
+// specialization constants of compute.comp, constant_id is the member index
+struct PerlinSpecialization {
+    uint32_t workgroupWidth = 16;
+    uint32_t workgroupHeight = 16;
+    // the output image size, the noise is scaled to it
+    uint32_t width = 0;
+    uint32_t height = 0;
+
+    static std::array<VkSpecializationMapEntry, 4> mapEntries();
+};
+
 struct ComputePipelines {
     Pipeline perlinNoisePipeline;
+    PerlinSpecialization perlinNoiseSpecialization;
 };
 
 struct ApplicationPipelines {
-    Pipeline opaquePipeline;
-    Pipeline transparentPipeline;
+    // permutations of simple_shader, the first has every feature and owns the layout and the shader
+    // modules of all of them. Models reference the elements, the list is not resized once built
+    std::vector<Pipeline> graphicsVariants;
+    // only created when the device supports descriptor indexing
+    Pipeline bindlessOpaquePipeline;
+    Pipeline bindlessTransparentPipeline;
+    // set before the bindless pipelines are submitted, they may still be compiling
+    bool bindless = false;
     ComputePipelines computePipelines;
 };
 
 struct TransparentPushConstants {
     glm::mat4 transform;
     glm::vec4 color;
+    // xy scale and zw offset applied to texture coordinates, places atlas entries
+    glm::vec4 uvTransform{1.0f, 1.0f, 0.0f, 0.0f};
+};
+
+struct BindlessPushConstants {
+    glm::mat4 transform;
+    glm::vec4 color;
+    glm::vec4 uvTransform;
+    uint32_t textureIndex;
 };
 
 struct PerlinPushConstants {
@@ -44,7 +118,14 @@ struct PerlinPushConstants {
     glm::float32 scale;
 };
 
+// push constant blocks use the std430 layout, the sizes are checked against the shaders when the
+// pipeline layouts are reflected
+static_assert(offsetof(TransparentPushConstants, color) == 64 && offsetof(TransparentPushConstants, uvTransform) == 80);
+static_assert(offsetof(BindlessPushConstants, uvTransform) == 80 && offsetof(BindlessPushConstants, textureIndex) == 96);
+static_assert(offsetof(PerlinPushConstants, scale) == 8);
+
 void destroyImage(VkDevice device, const AllocatedImage &img);
-void destroyApplicationPipelines(VkDevice device, const ApplicationPipelines &pipelines);
-void destroyPipeline(VkDevice device, const Pipeline &pipeline);
+void destroyApplicationPipelines(LveDevice &device, const ApplicationPipelines &pipelines);
+// also drops the push descriptor templates made for the pipeline layout
+void destroyPipeline(LveDevice &device, const Pipeline &pipeline);
 } // namespace lve
\ No newline at end of file
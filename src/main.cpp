@@ -1,14 +1,58 @@
 #include "first_app.hpp"
 
 // std
+#include <cstdint>
 #include <cstdlib>
 #include <iostream>
 #include <stdexcept>
+#include <string>
 
-int main() {
-    lve::FirstApp app{};
+namespace {
+// well past any display, the limiter sleeps less than a millisecond per frame above this
+constexpr uint32_t MAX_TARGET_FPS = 1000;
 
+// a whole number in [min, max], std::stoul alone accepts "-1" and trailing text
+uint32_t parseNumber(const std::string &option, const std::string &value, uint32_t min, uint32_t max) {
+    size_t end = 0;
+    long long number = -1;
     try {
+        number = std::stoll(value, &end);
+    } catch (const std::exception &) {
+        end = 0;
+    }
+    if (end == 0 || end != value.size() || number < min || number > max) {
+        throw std::runtime_error(option + " expects a number from " + std::to_string(min) + " to " + std::to_string(max) +
+                                 ", got " + value);
+    }
+    return static_cast<uint32_t>(number);
+}
+} // namespace
+
+int main(int argc, char **argv) {
+    try {
+        // --frames-in-flight 1 to 4, fewer lowers input latency, more keeps the GPU busier
+        // --present-mode fifo, fifo_relaxed, mailbox or immediate
+        // --fps caps the frame rate, e.g. so an uncapped present mode does not use a whole core
+        lve::FirstAppSettings settings;
+        for (int i = 1; i < argc; i += 2) {
+            std::string option = argv[i];
+            if (option != "--frames-in-flight" && option != "--present-mode" && option != "--fps") {
+                throw std::runtime_error("unknown option: " + option);
+            }
+            if (i + 1 == argc) {
+                throw std::runtime_error("missing value for " + option);
+            }
+            std::string value = argv[i + 1];
+            if (option == "--frames-in-flight") {
+                settings.framesInFlight = parseNumber(option, value, 1, lve::LveDevice::MAX_FRAMES_IN_FLIGHT);
+            } else if (option == "--present-mode") {
+                settings.presentMode = lve::LveSwapChain::presentModeFromName(value);
+            } else {
+                settings.targetFps = parseNumber(option, value, 0, MAX_TARGET_FPS);
+            }
+        }
+
+        lve::FirstApp app{settings};
         app.run();
     } catch (const std::exception &e) {
         std::cerr << e.what() << '\n';
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "lve_device.hpp"
+
+#include <glm/glm.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
+
+// std
+#include <array>
+#include <string>
+#include <vector>
+
+namespace lve {
+struct Vertex {
+    glm::vec3 pos;
+    glm::vec3 color;
+    glm::vec2 texCoord;
+
+    bool operator==(const Vertex &other) const {
+        return pos == other.pos && color == other.color && texCoord == other.texCoord;
+    }
+
+    static VkVertexInputBindingDescription getBindingDescription() {
+        VkVertexInputBindingDescription bindingDescription{};
+        bindingDescription.binding = 0;
+        bindingDescription.stride = sizeof(Vertex);
+        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescription;
+    }
+
+    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
+        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[0].offset = offsetof(Vertex, pos);
+
+        attributeDescriptions[1].binding = 0;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
+        attributeDescriptions[1].offset = offsetof(Vertex, color);
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+        attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
+        return attributeDescriptions;
+    }
+};
+
+// Vertex and index buffers loaded from an .obj file, shared between models through the asset cache
+class Mesh {
+public:
+    Mesh(LveDevice &device, const std::string &modelPath);
+    ~Mesh();
+
+    Mesh(const Mesh &) = delete;
+    Mesh operator=(const Mesh &) = delete;
+    Mesh(Mesh &&) = delete;
+    Mesh &operator=(Mesh &&) = delete;
+
+    void bind(VkCommandBuffer cmdBuffer);
+    void draw(VkCommandBuffer cmdBuffer);
+    VkDeviceSize getSize() { return sizeof(Vertex) * vertexCount + sizeof(uint32_t) * indexCount; }
+    // false when every vertex is white, the shader can skip reading the color
+    bool hasVertexColors() { return vertexColors; }
+
+private:
+    void loadModel(const std::string &modelPath);
+    void createIndexBuffer();
+    void createVertexBuffer();
+
+    LveDevice &lveDevice;
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    bool vertexColors = false;
+
+    VkBuffer vertexBuffer;
+    VkDeviceMemory vertexBufferMemory;
+    VkBuffer indexBuffer;
+    VkDeviceMemory indexBufferMemory;
+};
+} // namespace lve
+
+namespace std {
+template <> struct hash<lve::Vertex> {
+    size_t operator()(lve::Vertex const &vertex) const {
+        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
+               (hash<glm::vec2>()(vertex.texCoord) << 1);
+    }
+};
+} // namespace std
\ No newline at end of file
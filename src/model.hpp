@@ -1,16 +1,15 @@
 #pragma once
 
-#include "descriptor_allocator.hpp"
+#include "descriptor_set_cache.hpp"
 #include "lve_swap_chain.hpp"
 #include "lve_types.hpp"
+#include "mesh.hpp"
 
 #include <glm/glm.hpp>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
 // std
 #include <array>
+#include <memory>
 #include <vector>
 
 namespace lve {
@@ -20,47 +19,24 @@ struct UniformBufferObject {
     glm::mat4 proj;
 };
 
-struct Vertex {
-    glm::vec3 pos;
-    glm::vec3 color;
-    glm::vec2 texCoord;
-
-    bool operator==(const Vertex &other) const {
-        return pos == other.pos && color == other.color && texCoord == other.texCoord;
-    }
-
-    static VkVertexInputBindingDescription getBindingDescription() {
-        VkVertexInputBindingDescription bindingDescription{};
-        bindingDescription.binding = 0;
-        bindingDescription.stride = sizeof(Vertex);
-        bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-        return bindingDescription;
-    }
-
-    static std::array<VkVertexInputAttributeDescription, 3> getAttributeDescriptions() {
-        std::array<VkVertexInputAttributeDescription, 3> attributeDescriptions{};
-        attributeDescriptions[0].binding = 0;
-        attributeDescriptions[0].location = 0;
-        attributeDescriptions[0].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[0].offset = offsetof(Vertex, pos);
+// the per model set of the opaque and transparent pipelines
+struct ModelDescriptors {
+    VkDescriptorBufferInfo uniformBuffer;
+    VkDescriptorImageInfo texture;
 
-        attributeDescriptions[1].binding = 0;
-        attributeDescriptions[1].location = 1;
-        attributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;
-        attributeDescriptions[1].offset = offsetof(Vertex, color);
-
-        attributeDescriptions[2].binding = 0;
-        attributeDescriptions[2].location = 2;
-        attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
-        attributeDescriptions[2].offset = offsetof(Vertex, texCoord);
-        return attributeDescriptions;
-    }
+    static const std::vector<DescriptorTemplateEntry> &templateEntries();
 };
 
 class Model {
 public:
-    Model(LveDevice &device, Pipeline &pipeline, DescriptorAllocator &descriptorAllocator,
-          VkImageView textureImageView, VkSampler textureSampler, std::string modelPath);
+    // uniformBuffers holds one buffer per frame in flight, shared by the scene's models so models
+    // with the same texture share descriptor sets
+    Model(LveDevice &device, Pipeline &pipeline, DescriptorSetCache &descriptorSetCache,
+          const std::vector<VkBuffer> &uniformBuffers, std::shared_ptr<AllocatedImage> texture,
+          std::shared_ptr<Mesh> mesh);
+    // bindless, the texture is referenced by its index in the scene's BindlessSet
+    Model(LveDevice &device, Pipeline &pipeline, std::shared_ptr<AllocatedImage> texture,
+          uint32_t textureIndex, std::shared_ptr<Mesh> mesh);
     ~Model();
 
     Model(const Model &) = delete;
@@ -68,44 +44,35 @@ public:
     Model(Model &&) = delete;
     Model &operator=(Model &&) = delete;
 
+    // updates what bind needs for pipelineLayout, call on the render thread before binds are
+    // recorded, bind itself only reads the model and can be recorded from any thread
+    void prepareBind(VkPipelineLayout pipelineLayout);
     void bind(VkCommandBuffer cmdBuffer, VkPipelineLayout pipelineLayout, size_t currentFrame);
     void draw(VkCommandBuffer cmdBuffer);
-    void updateUniformBuffer(UniformBufferObject uniformBuffer, uint32_t currentImage);
 
     Pipeline getDrawPipeline() { return drawPipeline; }
+    uint32_t getTextureIndex() { return textureIndex; }
+    // set when the texture is a TextureAtlas page
+    void setUvTransform(glm::vec4 transform) { uvTransform = transform; }
+    glm::vec4 getUvTransform() { return uvTransform; }
 
 private:
-    void loadModel(std::string modelPath);
-    void createDescriptorSets(VkImageView textureImageView, VkSampler textureSampler);
-    void createIndexBuffer();
-    void createVertexBuffer();
-    void createUniformBuffers();
+    void createDescriptorSets(DescriptorSetCache &descriptorSetCache,
+                              const std::vector<VkBuffer> &uniformBuffers);
 
     LveDevice &lveDevice;
-    std::vector<Vertex> vertices;
-    std::vector<uint32_t> indices;
-    uint32_t vertexCount;
-    uint32_t indexCount;
-
-    VkBuffer vertexBuffer;
-    VkDeviceMemory vertexBufferMemory;
-    VkBuffer indexBuffer;
-    VkDeviceMemory indexBufferMemory;
+    std::shared_ptr<Mesh> mesh;
+    std::shared_ptr<AllocatedImage> texture;
     Pipeline &drawPipeline;
-    DescriptorAllocator &descriptorAllocator;
+    bool bindless = false;
+    uint32_t textureIndex = 0;
+    glm::vec4 uvTransform{1.0f, 1.0f, 0.0f, 0.0f};
 
+    DescriptorSetCache *descriptorSetCache = nullptr;
     std::vector<VkDescriptorSet> descriptorSets;
-    std::vector<VkBuffer> uniformBuffers;
-    std::vector<VkDeviceMemory> uniformBuffersMemory;
-    std::vector<void *> uniformBuffersMapped;
-};
-} // namespace lve
-
-namespace std {
-template <> struct hash<lve::Vertex> {
-    size_t operator()(lve::Vertex const &vertex) const {
-        return ((hash<glm::vec3>()(vertex.pos) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1) ^
-               (hash<glm::vec2>()(vertex.texCoord) << 1);
-    }
+    // with VK_KHR_push_descriptor, one per frame in flight instead of descriptorSets
+    VkDescriptorUpdateTemplate pushTemplate = VK_NULL_HANDLE;
+    VkPipelineLayout pushTemplateLayout = VK_NULL_HANDLE;
+    std::vector<ModelDescriptors> pushDescriptors;
 };
-} // namespace std
\ No newline at end of file
+} // namespace lve
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "parallel_recorder.hpp"
+#include "initializers/initializers.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <stdexcept>
+
+namespace lve {
+ParallelRecorder::ParallelRecorder(LveDevice &device) : device{device} {
+    threadCount = getMaxThreadCount();
+
+    VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    // buffers are never reset one by one, the whole pool is once per frame
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = device.findPhysicalQueueFamilies().graphicsFamily;
+
+    frameCommands.resize(device.getFramesInFlight());
+    for (std::vector<ThreadCommands> &threads : frameCommands) {
+        threads.resize(getMaxThreadCount());
+        for (ThreadCommands &commands : threads) {
+            if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &commands.pool) != VK_SUCCESS) {
+                throw std::runtime_error("failed to create recording command pool");
+            }
+        }
+    }
+}
+
+ParallelRecorder::~ParallelRecorder() {
+    // destroying a pool frees its buffers
+    for (std::vector<ThreadCommands> &threads : frameCommands) {
+        for (ThreadCommands &commands : threads) {
+            vkDestroyCommandPool(device.device(), commands.pool, nullptr);
+        }
+    }
+}
+
+void ParallelRecorder::beginFrame(uint32_t currentFrame) {
+    frameIndex = currentFrame;
+    for (ThreadCommands &commands : frameCommands[frameIndex]) {
+        vkResetCommandPool(device.device(), commands.pool, 0);
+        commands.used = 0;
+    }
+}
+
+void ParallelRecorder::record(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo &renderingInfo, uint32_t drawCount,
+                              const std::function<void(VkCommandBuffer cmd, uint32_t first, uint32_t last)> &recordRange) {
+    if (drawCount == 0) {
+        usedThreadCount = 0;
+        return;
+    }
+    usedThreadCount = std::clamp((drawCount + MIN_DRAWS_PER_THREAD - 1) / MIN_DRAWS_PER_THREAD, 1u, threadCount);
+
+    std::vector<VkCommandBuffer> secondaries(usedThreadCount);
+    // each range only touches its own pool and slot of secondaries
+    auto recordSlot = [&](uint32_t slot) {
+        uint32_t first = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * slot / usedThreadCount);
+        uint32_t last = static_cast<uint32_t>(static_cast<uint64_t>(drawCount) * (slot + 1) / usedThreadCount);
+        VkCommandBuffer cmd = beginSecondary(frameCommands[frameIndex][slot], renderingInfo);
+        recordRange(cmd, first, last);
+        if (vkEndCommandBuffer(cmd) != VK_SUCCESS) {
+            throw std::runtime_error("failed to record secondary command buffer");
+        }
+        secondaries[slot] = cmd;
+    };
+
+    std::vector<std::future<void>> futures;
+    for (uint32_t slot = 1; slot < usedThreadCount; slot++) {
+        futures.push_back(workers.submit([&recordSlot, slot] { recordSlot(slot); }));
+    }
+    // the workers reference this frame's locals, all of them finish before an error is passed on
+    std::exception_ptr error;
+    try {
+        recordSlot(0);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    for (std::future<void> &future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+
+    vkCmdExecuteCommands(primary, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+}
+
+void ParallelRecorder::setThreadCount(uint32_t count) { threadCount = std::clamp(count, 1u, getMaxThreadCount()); }
+
+VkCommandBuffer ParallelRecorder::beginSecondary(ThreadCommands &commands, const VkCommandBufferInheritanceRenderingInfo &renderingInfo) {
+    if (commands.used == commands.buffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        allocInfo.commandPool = commands.pool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+        VkCommandBuffer buffer;
+        if (vkAllocateCommandBuffers(device.device(), &allocInfo, &buffer) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate secondary command buffer");
+        }
+        commands.buffers.push_back(buffer);
+    }
+    VkCommandBuffer cmd = commands.buffers[commands.used++];
+
+    VkCommandBufferInheritanceInfo inheritanceInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO};
+    inheritanceInfo.pNext = &renderingInfo;
+    VkCommandBufferBeginInfo beginInfo =
+        init::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT);
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    if (vkBeginCommandBuffer(cmd, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin secondary command buffer");
+    }
+    // descriptor buffer bindings are not inherited either
+    if (device.isDescriptorBufferEnabled()) {
+        device.descriptorBuffer().bindBuffer(cmd);
+    }
+    return cmd;
+}
+} // namespace lve
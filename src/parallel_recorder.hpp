@@ -0,0 +1,67 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "utility/thread_pool.hpp"
+
+// std
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lve {
+// Records a list of draws into secondary command buffers on several threads. Every thread has
+// its own command pool per frame in flight, so a pool is never shared between threads or reset
+// before its frame has finished. The secondaries continue the primary's dynamic rendering through
+// VkCommandBufferInheritanceRenderingInfo and are executed in order, so the result is the same as
+// recording the list serially. The recorder has its own workers, recording is never queued
+// behind pipeline compiles or texture loads on the shared thread pool.
+class ParallelRecorder {
+public:
+    // fewer draws than this are not worth handing to another thread
+    static constexpr uint32_t MIN_DRAWS_PER_THREAD = 256;
+
+    explicit ParallelRecorder(LveDevice &device);
+    // the device has to be idle
+    ~ParallelRecorder();
+
+    // Not copyable or movable
+    ParallelRecorder(const ParallelRecorder &) = delete;
+    ParallelRecorder &operator=(const ParallelRecorder &) = delete;
+    ParallelRecorder(ParallelRecorder &&) = delete;
+    ParallelRecorder &operator=(ParallelRecorder &&) = delete;
+
+    // resets the frame's command pools, call after the frame was acquired
+    void beginFrame(uint32_t currentFrame);
+    // Splits drawCount into contiguous ranges and records each with recordRange(cmd, first, last)
+    // into its own secondary, the calling thread takes the first range. primary has to be inside
+    // vkCmdBeginRendering with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, renderingInfo
+    // lists its attachment formats. Secondaries only inherit the attachments, recordRange sets the
+    // viewport, pipelines and descriptors it draws with.
+    void record(VkCommandBuffer primary, const VkCommandBufferInheritanceRenderingInfo &renderingInfo, uint32_t drawCount,
+                const std::function<void(VkCommandBuffer cmd, uint32_t first, uint32_t last)> &recordRange);
+
+    uint32_t getMaxThreadCount() { return static_cast<uint32_t>(workers.threadCount()) + 1; }
+    uint32_t getThreadCount() { return threadCount; }
+    void setThreadCount(uint32_t count);
+    // threads the last record call used, fewer than getThreadCount() for short draw lists
+    uint32_t getUsedThreadCount() { return usedThreadCount; }
+
+private:
+    struct ThreadCommands {
+        VkCommandPool pool;
+        // allocated as needed, reused after the pool is reset
+        std::vector<VkCommandBuffer> buffers;
+        size_t used = 0;
+    };
+
+    VkCommandBuffer beginSecondary(ThreadCommands &commands, const VkCommandBufferInheritanceRenderingInfo &renderingInfo);
+
+    LveDevice &device;
+    util::ThreadPool workers;
+    // per frame in flight, one per thread
+    std::vector<std::vector<ThreadCommands>> frameCommands;
+    uint32_t frameIndex = 0;
+    uint32_t threadCount;
+    uint32_t usedThreadCount = 0;
+};
+} // namespace lve
@@ -2,7 +2,6 @@
 #include "model.hpp"
 
 // std
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 
@@ -15,29 +14,18 @@ void PipelineBuilder::clear() {
     pipelineLayout = {};
     depthStencil = {.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO};
     renderInfo = {.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR};
+    flags = 0;
+    dynamicDepthCull = false;
+    dynamicBlend = false;
     shaderStages.clear();
 }
 
-VkShaderModule PipelineBuilder::createShaderModule(VkDevice device, const std::string &filePath) {
-    std::ifstream file{filePath, std::ios::ate | std::ios::binary};
-
-    if (!file.is_open()) {
-        throw std::runtime_error("failed to open file: " + filePath);
-        return VK_NULL_HANDLE;
-    }
-
-    size_t fileSize = static_cast<size_t>(file.tellg());
-    std::vector<char> buffer(fileSize);
-
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
-
-    file.close();
-
+VkShaderModule PipelineBuilder::createShaderModule(VkDevice device,
+                                                   const std::vector<uint32_t> &code) {
     VkShaderModuleCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = buffer.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t *>(buffer.data());
+    createInfo.codeSize = code.size() * sizeof(uint32_t);
+    createInfo.pCode = code.data();
 
     VkShaderModule shaderModule;
 
@@ -49,7 +37,51 @@ VkShaderModule PipelineBuilder::createShaderModule(VkDevice device, const std::s
     return shaderModule;
 }
 
-VkPipeline PipelineBuilder::buildPipeline(VkDevice device) {
+VkPipeline PipelineBuilder::buildPipeline(LveDevice &device) {
+    return createGraphicsPipeline(device, 0);
+}
+
+VkPipeline PipelineBuilder::buildPipelineLibrary(LveDevice &device,
+                                                 VkGraphicsPipelineLibraryFlagBitsEXT part) {
+    return createGraphicsPipeline(device, part);
+}
+
+VkPipeline PipelineBuilder::linkPipeline(LveDevice &device,
+                                         const std::vector<VkPipeline> &libraries,
+                                         VkPipelineLayout layout, VkPipelineCreateFlags flags,
+                                         bool optimize) {
+    VkPipelineLibraryCreateInfoKHR libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR};
+    libraryInfo.libraryCount = static_cast<uint32_t>(libraries.size());
+    libraryInfo.pLibraries = libraries.data();
+
+    VkPipelineCreationFeedback creationFeedback{};
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+    feedbackInfo.pNext = &libraryInfo;
+    feedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+
+    // without link time optimization linking only stitches the compiled libraries together
+    VkGraphicsPipelineCreateInfo pipelineInfo = {
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
+    pipelineInfo.pNext = &feedbackInfo;
+    pipelineInfo.flags = flags;
+    if (optimize) {
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT;
+    }
+    pipelineInfo.layout = layout;
+
+    VkPipeline newPipeline;
+    if (vkCreateGraphicsPipelines(device.device(), device.pipelineCache().getCache(), 1,
+                                  &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
+        throw std::runtime_error("failed to link graphics pipeline");
+    }
+    device.pipelineCache().recordFeedback(creationFeedback);
+    return newPipeline;
+}
+
+VkPipeline PipelineBuilder::createGraphicsPipeline(LveDevice &device,
+                                                   VkGraphicsPipelineLibraryFlagsEXT libraryParts) {
     VkPipelineViewportStateCreateInfo viewportState = {};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.pNext = nullptr;
@@ -74,9 +106,17 @@ VkPipeline PipelineBuilder::buildPipeline(VkDevice device) {
     vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
     vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
 
+    // creation feedback tells whether the pipeline came out of the pipeline cache
+    VkPipelineCreationFeedback creationFeedback{};
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+    feedbackInfo.pNext = &renderInfo;
+    feedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+
     VkGraphicsPipelineCreateInfo pipelineInfo = {
         .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
-    pipelineInfo.pNext = &renderInfo;
+    pipelineInfo.pNext = &feedbackInfo;
+    pipelineInfo.flags = flags;
 
     pipelineInfo.stageCount = (uint32_t)shaderStages.size();
     pipelineInfo.pStages = shaderStages.data();
@@ -89,37 +129,106 @@ VkPipeline PipelineBuilder::buildPipeline(VkDevice device) {
     pipelineInfo.pDepthStencilState = &depthStencil;
     pipelineInfo.layout = pipelineLayout;
 
-    VkDynamicState state[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    std::vector<VkDynamicState> state = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    if (dynamicDepthCull) {
+        state.insert(state.end(), {VK_DYNAMIC_STATE_CULL_MODE,
+                                   VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE,
+                                   VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE,
+                                   VK_DYNAMIC_STATE_DEPTH_COMPARE_OP});
+    }
+    if (dynamicBlend) {
+        state.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+    }
 
     VkPipelineDynamicStateCreateInfo dynamicInfo = {
         .sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO};
-    dynamicInfo.pDynamicStates = &state[0];
-    dynamicInfo.dynamicStateCount = 2;
+    dynamicInfo.pDynamicStates = state.data();
+    dynamicInfo.dynamicStateCount = static_cast<uint32_t>(state.size());
 
     pipelineInfo.pDynamicState = &dynamicInfo;
 
+    // a library only takes the state of its own parts, the rest comes with the other libraries
+    VkGraphicsPipelineLibraryCreateInfoEXT libraryInfo{
+        .sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT};
+    std::vector<VkPipelineShaderStageCreateInfo> libraryStages;
+    if (libraryParts != 0) {
+        libraryInfo.flags = libraryParts;
+        libraryInfo.pNext = pipelineInfo.pNext;
+        pipelineInfo.pNext = &libraryInfo;
+        pipelineInfo.flags |= VK_PIPELINE_CREATE_LIBRARY_BIT_KHR |
+                              VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+
+        constexpr VkGraphicsPipelineLibraryFlagsEXT VERTEX_INPUT =
+            VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+        constexpr VkGraphicsPipelineLibraryFlagsEXT PRE_RASTERIZATION =
+            VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+        constexpr VkGraphicsPipelineLibraryFlagsEXT FRAGMENT_SHADER =
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+        constexpr VkGraphicsPipelineLibraryFlagsEXT FRAGMENT_OUTPUT =
+            VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+
+        for (const VkPipelineShaderStageCreateInfo &stage : shaderStages) {
+            VkGraphicsPipelineLibraryFlagsEXT stagePart =
+                stage.stage == VK_SHADER_STAGE_FRAGMENT_BIT ? FRAGMENT_SHADER : PRE_RASTERIZATION;
+            if ((libraryParts & stagePart) != 0) {
+                libraryStages.push_back(stage);
+            }
+        }
+        pipelineInfo.stageCount = static_cast<uint32_t>(libraryStages.size());
+        pipelineInfo.pStages = libraryStages.data();
+
+        if ((libraryParts & VERTEX_INPUT) == 0) {
+            pipelineInfo.pVertexInputState = nullptr;
+            pipelineInfo.pInputAssemblyState = nullptr;
+        }
+        if ((libraryParts & PRE_RASTERIZATION) == 0) {
+            pipelineInfo.pViewportState = nullptr;
+            pipelineInfo.pRasterizationState = nullptr;
+        }
+        if ((libraryParts & FRAGMENT_SHADER) == 0) {
+            pipelineInfo.pDepthStencilState = nullptr;
+        }
+        if ((libraryParts & FRAGMENT_OUTPUT) == 0) {
+            pipelineInfo.pColorBlendState = nullptr;
+        }
+        if ((libraryParts & (FRAGMENT_SHADER | FRAGMENT_OUTPUT)) == 0) {
+            pipelineInfo.pMultisampleState = nullptr;
+        }
+        if ((libraryParts & (PRE_RASTERIZATION | FRAGMENT_SHADER)) == 0) {
+            pipelineInfo.layout = VK_NULL_HANDLE;
+        }
+    }
+
     VkPipeline newPipeline;
-    if (vkCreateGraphicsPipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr,
-                                  &newPipeline) != VK_SUCCESS) {
+    if (vkCreateGraphicsPipelines(device.device(), device.pipelineCache().getCache(), 1,
+                                  &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create graphics pipeline");
         return VK_NULL_HANDLE;
     }
+    device.pipelineCache().recordFeedback(creationFeedback);
 
     return newPipeline;
 }
 
-VkPipeline PipelineBuilder::buildComputePipeline(VkDevice device) {
+VkPipeline PipelineBuilder::buildComputePipeline(LveDevice &device) {
+    VkPipelineCreationFeedback creationFeedback{};
+    VkPipelineCreationFeedbackCreateInfo feedbackInfo{
+        .sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO};
+    feedbackInfo.pPipelineCreationFeedback = &creationFeedback;
+
     VkComputePipelineCreateInfo pipelineInfo{.sType =
                                                  VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
-    pipelineInfo.pNext = nullptr;
+    pipelineInfo.pNext = &feedbackInfo;
+    pipelineInfo.flags = flags;
     pipelineInfo.stage = shaderStages[0];
     pipelineInfo.layout = pipelineLayout;
 
     VkPipeline newPipeline;
-    if (vkCreateComputePipelines(device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &newPipeline) !=
-        VK_SUCCESS) {
+    if (vkCreateComputePipelines(device.device(), device.pipelineCache().getCache(), 1,
+                                 &pipelineInfo, nullptr, &newPipeline) != VK_SUCCESS) {
         throw std::runtime_error("failed to create compute pipeline");
     }
+    device.pipelineCache().recordFeedback(creationFeedback);
     return newPipeline;
 }
 
@@ -129,8 +238,12 @@ void PipelineBuilder::setShaders(VkShaderModule vertexShader, VkShaderModule fra
     shaderStages.push_back(shaderStageCreateInfo(VK_SHADER_STAGE_FRAGMENT_BIT, fragmentShader));
 }
 
-void PipelineBuilder::setComputeShader(VkShaderModule computeShader) {
-    shaderStages.push_back(shaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, computeShader));
+void PipelineBuilder::setComputeShader(VkShaderModule computeShader,
+                                       const VkSpecializationInfo *specialization) {
+    VkPipelineShaderStageCreateInfo stage =
+        shaderStageCreateInfo(VK_SHADER_STAGE_COMPUTE_BIT, computeShader);
+    stage.pSpecializationInfo = specialization;
+    shaderStages.push_back(stage);
 }
 
 void PipelineBuilder::setInputTopology(VkPrimitiveTopology topology) {
@@ -207,6 +320,24 @@ void PipelineBuilder::enableDepthTest() {
     depthStencil.maxDepthBounds = 1.f;
 }
 
+void PipelineBuilder::setRenderState(const RenderState &state) {
+    rasterizer.cullMode = state.cullMode;
+    if (state.depthTest) {
+        enableDepthTest();
+    } else {
+        disableDepthTest();
+    }
+    depthStencil.depthWriteEnable = state.depthWrite;
+    depthStencil.depthCompareOp = state.depthCompareOp;
+    // with dynamic blend enable the pipeline needs the blend factors for the batches that blend
+    if (state.blend || dynamicBlend) {
+        enableBlending();
+        colorBlendAttachment.blendEnable = state.blend;
+    } else {
+        disableBlending();
+    }
+}
+
 VkPipelineShaderStageCreateInfo PipelineBuilder::shaderStageCreateInfo(VkShaderStageFlagBits flags,
                                                                        VkShaderModule module) {
     VkPipelineShaderStageCreateInfo createInfo{
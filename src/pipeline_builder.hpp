@@ -1,3 +1,5 @@
+#pragma once
+
 #include "lve_device.hpp"
 
 namespace lve {
@@ -14,16 +16,30 @@ public:
     VkPipelineDepthStencilStateCreateInfo depthStencil;
     VkPipelineRenderingCreateInfo renderInfo;
     VkFormat colorAttachmentformat;
+    VkPipelineCreateFlags flags;
+    // the RenderState fields left out of the pipeline, set per draw batch by DynamicState
+    bool dynamicDepthCull;
+    bool dynamicBlend;
 
     PipelineBuilder() { clear(); }
-    static VkShaderModule createShaderModule(VkDevice device, const std::string &filePath);
+    // code comes from the device's ShaderCompiler
+    static VkShaderModule createShaderModule(VkDevice device, const std::vector<uint32_t> &code);
 
     void clear();
 
-    VkPipeline buildPipeline(VkDevice device);
-    VkPipeline buildComputePipeline(VkDevice device);
+    // created through the device's pipeline cache
+    VkPipeline buildPipeline(LveDevice &device);
+    VkPipeline buildComputePipeline(LveDevice &device);
+    // one part of a graphics pipeline, compiled on its own with VK_EXT_graphics_pipeline_library
+    VkPipeline buildPipelineLibrary(LveDevice &device, VkGraphicsPipelineLibraryFlagBitsEXT part);
+    // a complete pipeline from the four libraries, optimize for a slower link time optimized one
+    static VkPipeline linkPipeline(LveDevice &device, const std::vector<VkPipeline> &libraries,
+                                   VkPipelineLayout layout, VkPipelineCreateFlags flags,
+                                   bool optimize);
     void setShaders(VkShaderModule vertexShader, VkShaderModule fragmentShader);
-    void setComputeShader(VkShaderModule computeShader);
+    // specialization has to stay alive until the pipeline is built
+    void setComputeShader(VkShaderModule computeShader,
+                          const VkSpecializationInfo *specialization = nullptr);
     void setInputTopology(VkPrimitiveTopology topology);
     void setPolygonMode(VkPolygonMode mode);
     void setCullMode(VkCullModeFlags cullMode, VkFrontFace frontFace);
@@ -34,8 +50,13 @@ public:
     void setDepthFormat(VkFormat format);
     void disableDepthTest();
     void enableDepthTest();
+    // fields that are dynamic still get set, the PipelineRegistry ignores them
+    void setRenderState(const RenderState &state);
 
 private:
+    // libraryParts of 0 builds the whole pipeline
+    VkPipeline createGraphicsPipeline(LveDevice &device,
+                                      VkGraphicsPipelineLibraryFlagsEXT libraryParts);
     static VkPipelineShaderStageCreateInfo shaderStageCreateInfo(VkShaderStageFlagBits flags,
                                                                  VkShaderModule module);
 };
@@ -0,0 +1,111 @@
+#include "pipeline_cache.hpp"
+
+// std
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+PipelineCache::PipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const std::string &filePath)
+    : device{device}, filePath{filePath} {
+    std::vector<char> data = loadData(properties);
+    loadedSize = data.size();
+
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = data.size();
+    cacheInfo.pInitialData = data.empty() ? nullptr : data.data();
+
+    if (vkCreatePipelineCache(device, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create pipeline cache!");
+    }
+}
+
+PipelineCache::~PipelineCache() {
+    save();
+    vkDestroyPipelineCache(device, pipelineCache, nullptr);
+}
+
+std::vector<char> PipelineCache::loadData(const VkPhysicalDeviceProperties &properties) {
+    std::ifstream file{filePath, std::ios::ate | std::ios::binary};
+    if (!file.is_open()) {
+        return {};
+    }
+    std::vector<char> data(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(data.data(), data.size());
+
+    // data from another driver or device would be ignored by the driver at best
+    VkPipelineCacheHeaderVersionOne header{};
+    if (data.size() < sizeof(header)) {
+        std::cout << "pipeline cache: " << filePath << " is too small, ignoring it" << std::endl;
+        return {};
+    }
+    memcpy(&header, data.data(), sizeof(header));
+    if (header.headerSize < sizeof(header) || header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE ||
+        header.vendorID != properties.vendorID || header.deviceID != properties.deviceID ||
+        memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+        std::cout << "pipeline cache: " << filePath << " was written by another device or driver, ignoring it" << std::endl;
+        return {};
+    }
+    std::cout << "pipeline cache: loaded " << data.size() << " bytes" << std::endl;
+    return data;
+}
+
+void PipelineCache::save() {
+    size_t dataSize = 0;
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+        return;
+    }
+    std::vector<char> data(dataSize);
+    if (vkGetPipelineCacheData(device, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+        std::cerr << "failed to read pipeline cache data" << std::endl;
+        return;
+    }
+
+    std::string tempPath = filePath + ".tmp";
+    std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+    file.write(data.data(), dataSize);
+    // a write can still fail while flushing, the old cache is only replaced by a complete file
+    file.flush();
+    file.close();
+    if (file.fail()) {
+        std::cerr << "failed to write pipeline cache: " << tempPath << std::endl;
+        return;
+    }
+    std::error_code error;
+    std::filesystem::rename(tempPath, filePath, error);
+    if (error) {
+        std::cerr << "failed to replace pipeline cache: " << error.message() << std::endl;
+    }
+}
+
+void PipelineCache::recordFeedback(const VkPipelineCreationFeedback &feedback) {
+    if (!(feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{mutex};
+    pipelineCount++;
+    if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) {
+        hits++;
+    }
+    creationNanoseconds += feedback.duration;
+}
+
+uint64_t PipelineCache::getPipelineCount() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return pipelineCount;
+}
+
+uint64_t PipelineCache::getHits() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return hits;
+}
+
+double PipelineCache::getCreationMilliseconds() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return creationNanoseconds / 1.0e6;
+}
+} // namespace lve
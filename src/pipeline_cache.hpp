@@ -0,0 +1,47 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lve {
+// The VkPipelineCache every pipeline is created with. It starts from the data saved by the last
+// run if that was written by the same driver and device, and is written back when the device is
+// destroyed. Creation feedback of the pipelines built with it is collected for the GUI.
+class PipelineCache {
+public:
+    PipelineCache(VkDevice device, const VkPhysicalDeviceProperties &properties, const std::string &filePath);
+    // saves the cache
+    ~PipelineCache();
+
+    PipelineCache(const PipelineCache &) = delete;
+    PipelineCache &operator=(const PipelineCache &) = delete;
+
+    VkPipelineCache getCache() { return pipelineCache; }
+    // writes to a temporary file first, so an interrupted save never leaves a torn cache behind
+    void save();
+
+    void recordFeedback(const VkPipelineCreationFeedback &feedback);
+    uint64_t getPipelineCount();
+    uint64_t getHits();
+    double getCreationMilliseconds();
+    size_t getLoadedSize() { return loadedSize; }
+
+private:
+    std::vector<char> loadData(const VkPhysicalDeviceProperties &properties);
+
+    VkDevice device;
+    std::string filePath;
+    VkPipelineCache pipelineCache = VK_NULL_HANDLE;
+    size_t loadedSize = 0;
+
+    std::mutex mutex;
+    uint64_t pipelineCount = 0;
+    uint64_t hits = 0;
+    uint64_t creationNanoseconds = 0;
+};
+} // namespace lve
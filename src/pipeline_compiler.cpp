@@ -0,0 +1,64 @@
+#include "pipeline_compiler.hpp"
+
+// std
+#include <chrono>
+
+namespace lve {
+PipelineCompiler::PipelineCompiler(util::ThreadPool &threadPool) : threadPool{threadPool} {}
+
+PipelineCompiler::~PipelineCompiler() { waitIdle(); }
+
+void PipelineCompiler::submit(PipelineGroup group, std::function<void()> build, bool deferred) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (deferred) {
+        deferredBuilds[group] = std::move(build);
+        return;
+    }
+    deferredBuilds.erase(group);
+    builds[group] = threadPool.submit(std::move(build)).share();
+}
+
+void PipelineCompiler::startDeferred() {
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto &[group, build] : deferredBuilds) {
+        builds[group] = threadPool.submit(std::move(build)).share();
+    }
+    deferredBuilds.clear();
+}
+
+void PipelineCompiler::wait(const std::vector<PipelineGroup> &groups) {
+    std::vector<std::shared_future<void>> futures;
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (PipelineGroup group : groups) {
+            auto deferred = deferredBuilds.find(group);
+            if (deferred != deferredBuilds.end()) {
+                builds[group] = threadPool.submit(std::move(deferred->second)).share();
+                deferredBuilds.erase(deferred);
+            }
+            auto it = builds.find(group);
+            if (it != builds.end()) {
+                futures.push_back(it->second);
+            }
+        }
+    }
+    for (std::shared_future<void> &future : futures) {
+        future.get();
+    }
+}
+
+void PipelineCompiler::waitIdle() {
+    // the pipelines are destroyed after this, so every group has to exist
+    startDeferred();
+    std::lock_guard<std::mutex> lock{mutex};
+    for (auto &[group, future] : builds) {
+        future.wait();
+    }
+}
+
+bool PipelineCompiler::isReady(PipelineGroup group) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = builds.find(group);
+    return it != builds.end() && it->second.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+} // namespace lve
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "utility/thread_pool.hpp"
+
+// std
+#include <functional>
+#include <future>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// pipelines that are created together, by one of the init::create*Pipelines functions
+enum class PipelineGroup { Graphics, Bindless, Compute };
+
+// Builds pipeline groups on the thread pool so startup does not wait for every pipeline. Whoever
+// draws with a group waits for just that group before using it, the others keep compiling in the
+// background. Deferred groups stay off the pool until they are waited for or startDeferred is
+// called, so they do not hold up the first scene's texture loads. Pipelines share the device's
+// PipelineCache, which is safe to use from every worker.
+class PipelineCompiler {
+public:
+    explicit PipelineCompiler(util::ThreadPool &threadPool);
+    // waits for every group still compiling
+    ~PipelineCompiler();
+
+    // Not copyable or movable
+    PipelineCompiler(const PipelineCompiler &) = delete;
+    PipelineCompiler &operator=(const PipelineCompiler &) = delete;
+    PipelineCompiler(PipelineCompiler &&) = delete;
+    PipelineCompiler &operator=(PipelineCompiler &&) = delete;
+
+    // build writes the group's pipelines, nothing may read them until wait returns
+    void submit(PipelineGroup group, std::function<void()> build, bool deferred = false);
+    // starts every deferred build
+    void startDeferred();
+    // starts the deferred builds among groups, rethrows the error of a failed build, groups that
+    // were never submitted are skipped
+    void wait(const std::vector<PipelineGroup> &groups);
+    // blocks until every build finished, failed or not, deferred builds are started first
+    void waitIdle();
+    bool isReady(PipelineGroup group);
+
+private:
+    util::ThreadPool &threadPool;
+    std::mutex mutex;
+    std::unordered_map<PipelineGroup, std::shared_future<void>> builds;
+    std::unordered_map<PipelineGroup, std::function<void()>> deferredBuilds;
+};
+} // namespace lve
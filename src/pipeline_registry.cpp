@@ -0,0 +1,411 @@
+#include "pipeline_registry.hpp"
+#include "lve_device.hpp"
+#include "pipeline_builder.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+template <typename T> void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // namespace
+
+PipelineRegistry::PipelineRegistry(LveDevice &device) : device{device} {}
+
+PipelineRegistry::~PipelineRegistry() {
+    for (Optimization &optimization : optimizations) {
+        try {
+            vkDestroyPipeline(device.device(), optimization.future.get(), nullptr);
+        } catch (const std::exception &) {
+            // nothing was created
+        }
+    }
+    for (const RetiredPipeline &retired : retiredPipelines) {
+        vkDestroyPipeline(device.device(), retired.pipeline, nullptr);
+    }
+    for (VkPipeline pipeline : pipelines) {
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+    }
+    for (auto &[key, library] : libraries) {
+        vkDestroyPipeline(device.device(), library.pipeline, nullptr);
+    }
+}
+
+PipelineId PipelineRegistry::getPipeline(PipelineBuilder &builder) {
+    PipelineKey key = makeKey(builder);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto it = ids.find(key);
+        if (it != ids.end()) {
+            hits++;
+            return it->second;
+        }
+    }
+
+    // built without the lock so pipelines compile in parallel, see PipelineCompiler
+    VkPipeline pipeline;
+    std::vector<VkPipeline> linkedLibraries;
+    if (key.compute) {
+        pipeline = builder.buildComputePipeline(device);
+    } else if (device.isGraphicsPipelineLibraryEnabled()) {
+        linkedLibraries = getLibraries(builder, key);
+        pipeline = PipelineBuilder::linkPipeline(device, linkedLibraries, key.layout, key.flags, false);
+    } else {
+        pipeline = builder.buildPipeline(device);
+    }
+
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = ids.find(key);
+    if (it != ids.end()) {
+        // another thread built the same state first
+        vkDestroyPipeline(device.device(), pipeline, nullptr);
+        releaseLibraries(linkedLibraries);
+        hits++;
+        return it->second;
+    }
+    misses++;
+    PipelineId id = static_cast<PipelineId>(pipelines.size());
+    pipelines.push_back(pipeline);
+    if (!linkedLibraries.empty()) {
+        links.emplace(id, Link{std::move(linkedLibraries), key.layout, key.flags});
+        unoptimized.push_back(id);
+    }
+    ids.emplace(std::move(key), id);
+    return id;
+}
+
+VkPipeline PipelineRegistry::getHandle(PipelineId id) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (id >= pipelines.size() || pipelines[id] == VK_NULL_HANDLE) {
+        throw std::runtime_error("failed to find pipeline, unknown pipeline id");
+    }
+    return pipelines[id];
+}
+
+void PipelineRegistry::releasePipeline(PipelineId id) {
+    std::unique_lock<std::mutex> lock{mutex};
+    if (id >= pipelines.size() || pipelines[id] == VK_NULL_HANDLE) {
+        throw std::runtime_error("failed to release pipeline, unknown pipeline id");
+    }
+
+    // the caller destroys the layout next, which an optimization in flight still links with
+    auto it = std::find_if(optimizations.begin(), optimizations.end(),
+                           [id](const Optimization &optimization) { return optimization.id == id; });
+    if (it != optimizations.end()) {
+        Optimization optimization = std::move(*it);
+        optimizations.erase(it);
+        // waited for without the lock, tasks queued before the link on the same pool may call getPipeline
+        lock.unlock();
+        optimization.future.wait();
+        lock.lock();
+        finishOptimization(optimization);
+    }
+
+    std::erase_if(ids, [id](const auto &entry) { return entry.second == id; });
+    vkDestroyPipeline(device.device(), pipelines[id], nullptr);
+    pipelines[id] = VK_NULL_HANDLE;
+    auto link = links.find(id);
+    if (link != links.end()) {
+        releaseLibraries(link->second.libraries);
+        links.erase(link);
+    }
+}
+
+void PipelineRegistry::update(util::ThreadPool &threadPool) {
+    std::lock_guard<std::mutex> lock{mutex};
+    frame++;
+
+    // a frame waits on the frame timeline for the frame framesInFlight before it, so by now every
+    // frame recorded with a replaced fast link has finished
+    while (!retiredPipelines.empty() && frame - retiredPipelines.front().frame >= device.getFramesInFlight()) {
+        vkDestroyPipeline(device.device(), retiredPipelines.front().pipeline, nullptr);
+        retiredPipelines.pop_front();
+    }
+
+    for (auto it = optimizations.begin(); it != optimizations.end();) {
+        if (it->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            it++;
+            continue;
+        }
+        finishOptimization(*it);
+        it = optimizations.erase(it);
+    }
+
+    for (PipelineId id : unoptimized) {
+        // the link keeps its libraries alive until the pipeline is released, which waits for this
+        auto link = links.find(id);
+        if (link == links.end()) {
+            continue;
+        }
+        Link linked = link->second;
+        std::future<VkPipeline> future = threadPool.submit([this, linked] {
+            return PipelineBuilder::linkPipeline(device, linked.libraries, linked.layout, linked.flags, true);
+        });
+        optimizations.push_back({id, std::move(future)});
+    }
+    unoptimized.clear();
+}
+
+void PipelineRegistry::waitIdle() {
+    std::unique_lock<std::mutex> lock{mutex};
+    std::vector<Optimization> pending = std::move(optimizations);
+    optimizations.clear();
+    // same as releasePipeline, the lock is not held while waiting on the thread pool
+    lock.unlock();
+    for (Optimization &optimization : pending) {
+        optimization.future.wait();
+    }
+    lock.lock();
+    for (Optimization &optimization : pending) {
+        finishOptimization(optimization);
+    }
+}
+
+void PipelineRegistry::finishOptimization(Optimization &optimization) {
+    VkPipeline optimized;
+    try {
+        optimized = optimization.future.get();
+    } catch (const std::exception &e) {
+        std::cerr << "pipeline optimization failed, keeping the fast link: " << e.what() << std::endl;
+        return;
+    }
+    // recorded command buffers may still use the fast link
+    retiredPipelines.push_back({frame, pipelines[optimization.id]});
+    pipelines[optimization.id] = optimized;
+    optimizedCount++;
+}
+
+std::vector<VkPipeline> PipelineRegistry::getLibraries(PipelineBuilder &builder, const PipelineKey &key) {
+    std::vector<VkPipeline> linkedLibraries;
+    for (VkGraphicsPipelineLibraryFlagBitsEXT part :
+         {VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+          VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT, VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT}) {
+        PipelineKey libraryKey = makeLibraryKey(key, part);
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            auto it = libraries.find(libraryKey);
+            if (it != libraries.end()) {
+                it->second.users++;
+                linkedLibraries.push_back(it->second.pipeline);
+                continue;
+            }
+        }
+
+        VkPipeline library = builder.buildPipelineLibrary(device, part);
+        std::lock_guard<std::mutex> lock{mutex};
+        auto [it, inserted] = libraries.try_emplace(std::move(libraryKey), Library{library, 0});
+        if (!inserted) {
+            // another thread built the same part first
+            vkDestroyPipeline(device.device(), library, nullptr);
+        }
+        it->second.users++;
+        linkedLibraries.push_back(it->second.pipeline);
+    }
+    return linkedLibraries;
+}
+
+void PipelineRegistry::releaseLibraries(const std::vector<VkPipeline> &linkedLibraries) {
+    for (VkPipeline pipeline : linkedLibraries) {
+        auto it = std::find_if(libraries.begin(), libraries.end(),
+                               [pipeline](const auto &entry) { return entry.second.pipeline == pipeline; });
+        if (it != libraries.end() && --it->second.users == 0) {
+            vkDestroyPipeline(device.device(), pipeline, nullptr);
+            libraries.erase(it);
+        }
+    }
+}
+
+size_t PipelineRegistry::size() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return ids.size();
+}
+
+size_t PipelineRegistry::getLibraryCount() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return libraries.size();
+}
+
+uint64_t PipelineRegistry::getOptimizedCount() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return optimizedCount;
+}
+
+uint64_t PipelineRegistry::getHits() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return hits;
+}
+
+uint64_t PipelineRegistry::getMisses() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return misses;
+}
+
+PipelineRegistry::PipelineKey PipelineRegistry::makeKey(const PipelineBuilder &builder) {
+    PipelineKey key{};
+    key.layout = builder.pipelineLayout;
+    key.flags = builder.flags;
+    for (const VkPipelineShaderStageCreateInfo &stage : builder.shaderStages) {
+        ShaderKey shader{stage.stage, stage.module, stage.pName};
+        if (const VkSpecializationInfo *specialization = stage.pSpecializationInfo) {
+            for (uint32_t i = 0; i < specialization->mapEntryCount; i++) {
+                const VkSpecializationMapEntry &entry = specialization->pMapEntries[i];
+                shader.specializationEntries.insert(shader.specializationEntries.end(),
+                                                    {entry.constantID, entry.offset, static_cast<uint32_t>(entry.size)});
+            }
+            const uint8_t *data = static_cast<const uint8_t *>(specialization->pData);
+            shader.specializationData.assign(data, data + specialization->dataSize);
+        }
+        key.shaders.push_back(std::move(shader));
+    }
+    key.compute = key.shaders.size() == 1 && key.shaders[0].stage == VK_SHADER_STAGE_COMPUTE_BIT;
+    if (key.compute) {
+        return key;
+    }
+
+    key.topology = builder.inputAssembly.topology;
+    key.primitiveRestart = builder.inputAssembly.primitiveRestartEnable;
+    key.polygonMode = builder.rasterizer.polygonMode;
+    key.dynamicDepthCull = builder.dynamicDepthCull;
+    key.dynamicBlend = builder.dynamicBlend;
+    if (!key.dynamicDepthCull) {
+        key.cullMode = builder.rasterizer.cullMode;
+        key.depthTest = builder.depthStencil.depthTestEnable;
+        key.depthWrite = builder.depthStencil.depthWriteEnable;
+        key.depthCompareOp = builder.depthStencil.depthCompareOp;
+    }
+    key.frontFace = builder.rasterizer.frontFace;
+    key.lineWidth = builder.rasterizer.lineWidth;
+    key.samples = builder.multisampling.rasterizationSamples;
+    key.sampleShading = builder.multisampling.sampleShadingEnable;
+    key.minSampleShading = builder.multisampling.minSampleShading;
+    key.alphaToCoverage = builder.multisampling.alphaToCoverageEnable;
+    key.alphaToOne = builder.multisampling.alphaToOneEnable;
+    const VkPipelineColorBlendAttachmentState &blend = builder.colorBlendAttachment;
+    if (!key.dynamicBlend) {
+        key.blendEnable = blend.blendEnable;
+    }
+    key.srcColorBlendFactor = blend.srcColorBlendFactor;
+    key.dstColorBlendFactor = blend.dstColorBlendFactor;
+    key.colorBlendOp = blend.colorBlendOp;
+    key.srcAlphaBlendFactor = blend.srcAlphaBlendFactor;
+    key.dstAlphaBlendFactor = blend.dstAlphaBlendFactor;
+    key.alphaBlendOp = blend.alphaBlendOp;
+    key.colorWriteMask = blend.colorWriteMask;
+    if (builder.renderInfo.colorAttachmentCount > 0) {
+        key.colorFormat = builder.colorAttachmentformat;
+    }
+    key.depthFormat = builder.renderInfo.depthAttachmentFormat;
+    return key;
+}
+
+PipelineRegistry::PipelineKey PipelineRegistry::makeLibraryKey(const PipelineKey &key, VkGraphicsPipelineLibraryFlagBitsEXT part) {
+    PipelineKey libraryKey{};
+    libraryKey.libraryPart = part;
+    libraryKey.flags = key.flags;
+    switch (part) {
+    case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+        libraryKey.topology = key.topology;
+        libraryKey.primitiveRestart = key.primitiveRestart;
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+        libraryKey.layout = key.layout;
+        std::copy_if(key.shaders.begin(), key.shaders.end(), std::back_inserter(libraryKey.shaders),
+                     [](const ShaderKey &shader) { return shader.stage != VK_SHADER_STAGE_FRAGMENT_BIT; });
+        libraryKey.polygonMode = key.polygonMode;
+        libraryKey.cullMode = key.cullMode;
+        libraryKey.frontFace = key.frontFace;
+        libraryKey.lineWidth = key.lineWidth;
+        libraryKey.dynamicDepthCull = key.dynamicDepthCull;
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+        libraryKey.layout = key.layout;
+        std::copy_if(key.shaders.begin(), key.shaders.end(), std::back_inserter(libraryKey.shaders),
+                     [](const ShaderKey &shader) { return shader.stage == VK_SHADER_STAGE_FRAGMENT_BIT; });
+        libraryKey.samples = key.samples;
+        libraryKey.sampleShading = key.sampleShading;
+        libraryKey.minSampleShading = key.minSampleShading;
+        libraryKey.depthTest = key.depthTest;
+        libraryKey.depthWrite = key.depthWrite;
+        libraryKey.depthCompareOp = key.depthCompareOp;
+        libraryKey.dynamicDepthCull = key.dynamicDepthCull;
+        libraryKey.colorFormat = key.colorFormat;
+        libraryKey.depthFormat = key.depthFormat;
+        break;
+    case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+        libraryKey.samples = key.samples;
+        libraryKey.sampleShading = key.sampleShading;
+        libraryKey.minSampleShading = key.minSampleShading;
+        libraryKey.alphaToCoverage = key.alphaToCoverage;
+        libraryKey.alphaToOne = key.alphaToOne;
+        libraryKey.blendEnable = key.blendEnable;
+        libraryKey.srcColorBlendFactor = key.srcColorBlendFactor;
+        libraryKey.dstColorBlendFactor = key.dstColorBlendFactor;
+        libraryKey.colorBlendOp = key.colorBlendOp;
+        libraryKey.srcAlphaBlendFactor = key.srcAlphaBlendFactor;
+        libraryKey.dstAlphaBlendFactor = key.dstAlphaBlendFactor;
+        libraryKey.alphaBlendOp = key.alphaBlendOp;
+        libraryKey.colorWriteMask = key.colorWriteMask;
+        libraryKey.dynamicBlend = key.dynamicBlend;
+        libraryKey.colorFormat = key.colorFormat;
+        libraryKey.depthFormat = key.depthFormat;
+        break;
+    default:
+        break;
+    }
+    return libraryKey;
+}
+
+size_t PipelineRegistry::PipelineKeyHash::operator()(const PipelineKey &key) const {
+    size_t seed = 0;
+    hashCombine(seed, key.compute);
+    hashCombine(seed, key.layout);
+    hashCombine(seed, key.flags);
+    for (const ShaderKey &shader : key.shaders) {
+        hashCombine(seed, static_cast<int>(shader.stage));
+        hashCombine(seed, shader.module);
+        hashCombine(seed, shader.entryPoint);
+        for (uint32_t value : shader.specializationEntries) {
+            hashCombine(seed, value);
+        }
+        for (uint8_t byte : shader.specializationData) {
+            hashCombine(seed, byte);
+        }
+    }
+    hashCombine(seed, static_cast<int>(key.topology));
+    hashCombine(seed, key.primitiveRestart);
+    hashCombine(seed, static_cast<int>(key.polygonMode));
+    hashCombine(seed, key.cullMode);
+    hashCombine(seed, static_cast<int>(key.frontFace));
+    hashCombine(seed, key.lineWidth);
+    hashCombine(seed, static_cast<int>(key.samples));
+    hashCombine(seed, key.sampleShading);
+    hashCombine(seed, key.minSampleShading);
+    hashCombine(seed, key.alphaToCoverage);
+    hashCombine(seed, key.alphaToOne);
+    hashCombine(seed, key.blendEnable);
+    hashCombine(seed, static_cast<int>(key.srcColorBlendFactor));
+    hashCombine(seed, static_cast<int>(key.dstColorBlendFactor));
+    hashCombine(seed, static_cast<int>(key.colorBlendOp));
+    hashCombine(seed, static_cast<int>(key.srcAlphaBlendFactor));
+    hashCombine(seed, static_cast<int>(key.dstAlphaBlendFactor));
+    hashCombine(seed, static_cast<int>(key.alphaBlendOp));
+    hashCombine(seed, key.colorWriteMask);
+    hashCombine(seed, key.depthTest);
+    hashCombine(seed, key.depthWrite);
+    hashCombine(seed, static_cast<int>(key.depthCompareOp));
+    hashCombine(seed, static_cast<int>(key.colorFormat));
+    hashCombine(seed, static_cast<int>(key.depthFormat));
+    hashCombine(seed, key.dynamicDepthCull);
+    hashCombine(seed, key.dynamicBlend);
+    hashCombine(seed, key.libraryPart);
+    return seed;
+}
+} // namespace lve
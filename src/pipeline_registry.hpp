@@ -0,0 +1,159 @@
+#pragma once
+
+#include "lve_types.hpp"
+#include "utility/thread_pool.hpp"
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+class LveDevice;
+class PipelineBuilder;
+
+// Device-wide registry of pipelines keyed by the full PipelineBuilder state. A pipeline is created
+// the first time its state is asked for, after that the same state returns the same PipelineId.
+// Ids are small and dense, so draws can be sorted by them. Pipelines live until they are released
+// or the device is destroyed, callers never destroy a pipeline returned from here.
+//
+// With VK_EXT_graphics_pipeline_library a graphics pipeline is linked from four libraries, vertex
+// input, pre-rasterization shaders, fragment shader and fragment output, each compiled once and shared
+// by every pipeline with the same state for that part. The fast link is handed out right away and
+// replaced by a link time optimized pipeline compiled on the thread pool, so the handle behind an id
+// can change between frames.
+class PipelineRegistry {
+public:
+    explicit PipelineRegistry(LveDevice &device);
+    ~PipelineRegistry();
+
+    PipelineRegistry(const PipelineRegistry &) = delete;
+    PipelineRegistry &operator=(const PipelineRegistry &) = delete;
+
+    // a compute pipeline when the builder holds a single compute stage, otherwise graphics
+    PipelineId getPipeline(PipelineBuilder &builder);
+    VkPipeline getHandle(PipelineId id);
+    // destroys the pipeline, it must be out of flight. The id is not handed out again
+    void releasePipeline(PipelineId id);
+    // once per frame before recording, starts optimizing new links and swaps in finished ones
+    void update(util::ThreadPool &threadPool);
+    // optimizations link with pipeline layouts, wait for them before destroying those
+    void waitIdle();
+    size_t size();
+    size_t getLibraryCount();
+    uint64_t getOptimizedCount();
+    uint64_t getHits();
+    uint64_t getMisses();
+
+private:
+    struct ShaderKey {
+        VkShaderStageFlagBits stage;
+        VkShaderModule module;
+        std::string entryPoint;
+        // constant id, offset and size of each map entry, then the constant data
+        std::vector<uint32_t> specializationEntries;
+        std::vector<uint8_t> specializationData;
+
+        bool operator==(const ShaderKey &other) const = default;
+    };
+
+    // every builder field the pipeline depends on, graphics fields stay zero for compute and so do
+    // fields that are dynamic state
+    struct PipelineKey {
+        bool compute = false;
+        VkPipelineLayout layout = VK_NULL_HANDLE;
+        VkPipelineCreateFlags flags = 0;
+        std::vector<ShaderKey> shaders;
+        VkPrimitiveTopology topology{};
+        VkBool32 primitiveRestart = VK_FALSE;
+        VkPolygonMode polygonMode{};
+        VkCullModeFlags cullMode = 0;
+        VkFrontFace frontFace{};
+        float lineWidth = 0.0f;
+        VkSampleCountFlagBits samples{};
+        VkBool32 sampleShading = VK_FALSE;
+        float minSampleShading = 0.0f;
+        VkBool32 alphaToCoverage = VK_FALSE;
+        VkBool32 alphaToOne = VK_FALSE;
+        VkBool32 blendEnable = VK_FALSE;
+        VkBlendFactor srcColorBlendFactor{};
+        VkBlendFactor dstColorBlendFactor{};
+        VkBlendOp colorBlendOp{};
+        VkBlendFactor srcAlphaBlendFactor{};
+        VkBlendFactor dstAlphaBlendFactor{};
+        VkBlendOp alphaBlendOp{};
+        VkColorComponentFlags colorWriteMask = 0;
+        VkBool32 depthTest = VK_FALSE;
+        VkBool32 depthWrite = VK_FALSE;
+        VkCompareOp depthCompareOp{};
+        VkFormat colorFormat = VK_FORMAT_UNDEFINED;
+        VkFormat depthFormat = VK_FORMAT_UNDEFINED;
+        bool dynamicDepthCull = false;
+        bool dynamicBlend = false;
+        // set for the key of a pipeline library, only the fields of that part are filled in
+        VkGraphicsPipelineLibraryFlagsEXT libraryPart = 0;
+
+        bool operator==(const PipelineKey &other) const = default;
+    };
+
+    struct PipelineKeyHash {
+        size_t operator()(const PipelineKey &key) const;
+    };
+
+    struct Library {
+        VkPipeline pipeline;
+        // linked pipelines using it
+        uint32_t users;
+    };
+
+    // what a pipeline was linked from, kept until it is released
+    struct Link {
+        std::vector<VkPipeline> libraries;
+        VkPipelineLayout layout;
+        VkPipelineCreateFlags flags;
+    };
+
+    struct Optimization {
+        PipelineId id;
+        std::future<VkPipeline> future;
+    };
+
+    struct RetiredPipeline {
+        // update call the pipeline was replaced in
+        uint64_t frame;
+        VkPipeline pipeline;
+    };
+
+    static PipelineKey makeKey(const PipelineBuilder &builder);
+    static PipelineKey makeLibraryKey(const PipelineKey &key, VkGraphicsPipelineLibraryFlagBitsEXT part);
+    // the four libraries of the builder's pipeline, each counts the caller as a user
+    std::vector<VkPipeline> getLibraries(PipelineBuilder &builder, const PipelineKey &key);
+    // the following expect the lock to be held
+    void releaseLibraries(const std::vector<VkPipeline> &linkedLibraries);
+    void finishOptimization(Optimization &optimization);
+
+    LveDevice &device;
+    std::mutex mutex;
+    std::unordered_map<PipelineKey, PipelineId, PipelineKeyHash> ids;
+    // indexed by PipelineId
+    std::vector<VkPipeline> pipelines;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+
+    std::unordered_map<PipelineKey, Library, PipelineKeyHash> libraries;
+    std::unordered_map<PipelineId, Link> links;
+    // linked since the last update
+    std::vector<PipelineId> unoptimized;
+    std::vector<Optimization> optimizations;
+    std::deque<RetiredPipeline> retiredPipelines;
+    uint64_t frame = 0;
+    uint64_t optimizedCount = 0;
+};
+} // namespace lve
@@ -0,0 +1,79 @@
+#include "sampler_cache.hpp"
+
+// std
+#include <functional>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+template <typename T> void hashCombine(size_t &seed, const T &value) {
+    seed ^= std::hash<T>{}(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
+} // namespace
+
+SamplerCache::SamplerCache(VkDevice device) : device{device} {}
+
+SamplerCache::~SamplerCache() {
+    for (auto &[key, sampler] : samplers) {
+        vkDestroySampler(device, sampler, nullptr);
+    }
+}
+
+VkSampler SamplerCache::getSampler(const VkSamplerCreateInfo &createInfo) {
+    // extension structs would have to be part of the key
+    if (createInfo.pNext != nullptr) {
+        throw std::runtime_error("sampler cache does not support chained sampler create info");
+    }
+
+    SamplerKey key{createInfo};
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = samplers.find(key);
+    if (it != samplers.end()) {
+        return it->second;
+    }
+
+    VkSampler sampler;
+    if (vkCreateSampler(device, &createInfo, nullptr, &sampler) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture sampler!");
+    }
+    samplers.emplace(key, sampler);
+    return sampler;
+}
+
+size_t SamplerCache::size() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return samplers.size();
+}
+
+bool SamplerCache::SamplerKey::operator==(const SamplerKey &other) const {
+    const VkSamplerCreateInfo &a = info;
+    const VkSamplerCreateInfo &b = other.info;
+    return a.flags == b.flags && a.magFilter == b.magFilter && a.minFilter == b.minFilter && a.mipmapMode == b.mipmapMode &&
+           a.addressModeU == b.addressModeU && a.addressModeV == b.addressModeV && a.addressModeW == b.addressModeW &&
+           a.mipLodBias == b.mipLodBias && a.anisotropyEnable == b.anisotropyEnable && a.maxAnisotropy == b.maxAnisotropy &&
+           a.compareEnable == b.compareEnable && a.compareOp == b.compareOp && a.minLod == b.minLod && a.maxLod == b.maxLod &&
+           a.borderColor == b.borderColor && a.unnormalizedCoordinates == b.unnormalizedCoordinates;
+}
+
+size_t SamplerCache::SamplerKeyHash::operator()(const SamplerKey &key) const {
+    const VkSamplerCreateInfo &info = key.info;
+    size_t seed = 0;
+    hashCombine(seed, info.flags);
+    hashCombine(seed, static_cast<int>(info.magFilter));
+    hashCombine(seed, static_cast<int>(info.minFilter));
+    hashCombine(seed, static_cast<int>(info.mipmapMode));
+    hashCombine(seed, static_cast<int>(info.addressModeU));
+    hashCombine(seed, static_cast<int>(info.addressModeV));
+    hashCombine(seed, static_cast<int>(info.addressModeW));
+    hashCombine(seed, info.mipLodBias);
+    hashCombine(seed, info.anisotropyEnable);
+    hashCombine(seed, info.maxAnisotropy);
+    hashCombine(seed, info.compareEnable);
+    hashCombine(seed, static_cast<int>(info.compareOp));
+    hashCombine(seed, info.minLod);
+    hashCombine(seed, info.maxLod);
+    hashCombine(seed, static_cast<int>(info.borderColor));
+    hashCombine(seed, info.unnormalizedCoordinates);
+    return seed;
+}
+} // namespace lve
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace lve {
+// Device-wide cache of samplers keyed by their create info. Samplers are shared and live until
+// the device is destroyed, so callers never destroy a sampler returned from here.
+class SamplerCache {
+public:
+    explicit SamplerCache(VkDevice device);
+    ~SamplerCache();
+
+    SamplerCache(const SamplerCache &) = delete;
+    SamplerCache &operator=(const SamplerCache &) = delete;
+
+    VkSampler getSampler(const VkSamplerCreateInfo &createInfo);
+    size_t size();
+
+private:
+    struct SamplerKey {
+        VkSamplerCreateInfo info;
+
+        bool operator==(const SamplerKey &other) const;
+    };
+
+    struct SamplerKeyHash {
+        size_t operator()(const SamplerKey &key) const;
+    };
+
+    VkDevice device;
+    std::mutex mutex;
+    std::unordered_map<SamplerKey, VkSampler, SamplerKeyHash> samplers;
+};
+} // namespace lve
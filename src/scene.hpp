@@ -1,9 +1,12 @@
 #pragma once
 
+#include "asset_cache.hpp"
 #include "camera.hpp"
 #include "descriptor_allocator.hpp"
 #include "lve_types.hpp"
 #include "model.hpp"
+#include "pipeline_compiler.hpp"
+#include "utility/thread_pool.hpp"
 
 #include <iostream>
 #include <map>
@@ -13,22 +16,36 @@
 namespace lve {
 class IScene {
 public:
-    IScene(LveDevice &device, ApplicationPipelines pipelines, GLFWwindow *window)
-        : lveDevice{device}, pipelines{pipelines}, camera{window} {}
+    IScene(LveDevice &device, ApplicationPipelines &pipelines, util::ThreadPool &threadPool, AssetCache &assetCache, GLFWwindow *window)
+        : lveDevice{device}, pipelines{pipelines}, threadPool{threadPool}, assetCache{assetCache}, camera{window} {}
     virtual ~IScene() = default;
     virtual void initScene() = 0;
     virtual void destroyScene() = 0;
     virtual void draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageIndex, uint32_t currentFrame) = 0;
     virtual void showSceneGui() = 0;
     virtual void updateUniformBuffer(uint32_t currentImage, uint32_t width, uint32_t height) = 0;
+    // waited for before initScene, pipelines may still be compiling when the scene is constructed
+    virtual std::vector<PipelineGroup> getRequiredPipelines() = 0;
+    // pipelines were replaced by a shader reload, draws are keyed by copies of the old ones
+    virtual void reloadPipelines() {
+        std::map<Pipeline, std::vector<std::unique_ptr<Model>>> reloaded;
+        for (auto &[pipeline, models] : pipelineToModelMap) {
+            for (auto &model : models) {
+                reloaded[model->getDrawPipeline()].push_back(std::move(model));
+            }
+        }
+        pipelineToModelMap = std::move(reloaded);
+    }
     std::string getName() { return sceneName; }
 
 protected:
     virtual void createDescriptorPool() = 0;
 
     std::string sceneName;
-    ApplicationPipelines pipelines;
+    ApplicationPipelines &pipelines;
     LveDevice &lveDevice;
+    util::ThreadPool &threadPool;
+    AssetCache &assetCache;
     DescriptorAllocator descriptorAllocator{lveDevice};
     Camera camera;
 
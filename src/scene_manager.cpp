@@ -5,8 +5,10 @@
 #include "imgui.h"
 
 namespace lve {
-SceneManager::SceneManager(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window)
-    : device{device}, pipelines{pipelines}, window{window} {
+SceneManager::SceneManager(LveDevice &device, ApplicationPipelines &pipelines, PipelineCompiler &pipelineCompiler,
+                           util::ThreadPool &threadPool, AssetCache &assetCache, GLFWwindow *window)
+    : device{device}, pipelines{pipelines}, pipelineCompiler{pipelineCompiler}, threadPool{threadPool}, assetCache{assetCache},
+      window{window} {
     initScenes();
 }
 
@@ -14,10 +16,13 @@ SceneManager::~SceneManager() { currentScene->destroyScene(); }
 
 void SceneManager::changeScene() {
     if (currentScene) {
+        // the outgoing scene's resources may still be referenced by frames in flight
+        vkDeviceWaitIdle(device.device());
         currentScene->destroyScene();
         currentScene.reset();
     }
     currentScene = scenes[sceneChangeIdx];
+    pipelineCompiler.wait(currentScene->getRequiredPipelines());
     currentScene->initScene();
     _shouldChangeScene = false;
 }
@@ -38,8 +43,8 @@ void SceneManager::showSceneSelectGui() {
 }
 
 void SceneManager::initScenes() {
-    scenes.push_back(std::make_shared<DemoScene>(device, pipelines, window));
-    scenes.push_back(std::make_shared<ComputeScene>(device, pipelines, window));
+    scenes.push_back(std::make_shared<DemoScene>(device, pipelines, threadPool, assetCache, window));
+    scenes.push_back(std::make_shared<ComputeScene>(device, pipelines, threadPool, assetCache, window));
     changeScene();
 }
 } // namespace lve
\ No newline at end of file
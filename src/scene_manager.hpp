@@ -5,7 +5,8 @@
 namespace lve {
 class SceneManager {
 public:
-    SceneManager(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window);
+    SceneManager(LveDevice &device, ApplicationPipelines &pipelines, PipelineCompiler &pipelineCompiler, util::ThreadPool &threadPool,
+                 AssetCache &assetCache, GLFWwindow *window);
     ~SceneManager();
     void changeScene();
     void showSceneSelectGui();
@@ -18,7 +19,10 @@ private:
     int sceneChangeIdx = 0;
     bool _shouldChangeScene = false;
     LveDevice &device;
-    ApplicationPipelines pipelines;
+    ApplicationPipelines &pipelines;
+    PipelineCompiler &pipelineCompiler;
+    util::ThreadPool &threadPool;
+    AssetCache &assetCache;
     std::shared_ptr<IScene> currentScene;
     std::vector<std::shared_ptr<IScene>> scenes;
     GLFWwindow *window;
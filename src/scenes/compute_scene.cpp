@@ -2,10 +2,23 @@
 #include "imgui.h"
 
 #include "../initializers/images.hpp"
+#include "../initializers/pipelines.hpp"
 #include "../utility/images.hpp"
 
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+
 namespace lve {
-ComputeScene::ComputeScene(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window) : IScene{device, pipelines, window} {
+const std::vector<DescriptorTemplateEntry> &ComputeDescriptors::templateEntries() {
+    static const std::vector<DescriptorTemplateEntry> entries = {
+        DescriptorTemplateEntry::image(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, offsetof(ComputeDescriptors, image))};
+    return entries;
+}
+
+ComputeScene::ComputeScene(LveDevice &device, ApplicationPipelines &pipelines, util::ThreadPool &threadPool, AssetCache &assetCache,
+                           GLFWwindow *window)
+    : IScene{device, pipelines, threadPool, assetCache, window} {
     sceneName = "Compute Preview Scene";
     pushConstants.scale = 10.0f;
 }
@@ -15,21 +28,23 @@ ComputeScene::~ComputeScene() {}
 void ComputeScene::initScene() {
     createComputeImages();
     createDescriptorPool();
-    createDescriptorSets();
 }
 
 void ComputeScene::destroyScene() {
-    descriptorAllocator.destroyDescriptorPool();
+    frameDescriptorAllocator.destroyDescriptorPools();
 
     for (AllocatedImage image : computeImages) {
         destroyImage(lveDevice.device(), image);
     }
+    computeImages.clear();
 }
 
 void ComputeScene::createComputeImages() {
-    for (int i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
+    const PerlinSpecialization &specialization = pipelines.computePipelines.perlinNoiseSpecialization;
+    extent = {specialization.width, specialization.height};
+    for (uint32_t i = 0; i < lveDevice.getFramesInFlight(); i++) {
         AllocatedImage image;
-        init::createImage(&lveDevice, width, height, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_TILING_LINEAR,
+        init::createImage(&lveDevice, extent.width, extent.height, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_TILING_LINEAR,
                           VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, 0, image);
         computeImages.push_back(image);
     }
@@ -37,44 +52,41 @@ void ComputeScene::createComputeImages() {
 
 void ComputeScene::createDescriptorPool() {
     std::vector<VkDescriptorPoolSize> poolSizes{};
-    poolSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, static_cast<uint32_t>(LveSwapChain::MAX_FRAMES_IN_FLIGHT)});
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1});
 
-    descriptorAllocator.createDescriptorPool(poolSizes, 10);
+    frameDescriptorAllocator.createDescriptorPools(poolSizes, 1);
 }
 
-void ComputeScene::createDescriptorSets() {
-    descriptorAllocator.allocateDescriptorSets(pipelines.computePipelines.perlinNoisePipeline.descriptorSetLayout, computeDescriptorSets);
-
-    for (size_t i = 0; i < LveSwapChain::MAX_FRAMES_IN_FLIGHT; i++) {
-        VkDescriptorImageInfo imageInfo{};
-        imageInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
-        imageInfo.imageView = computeImages[i].view;
-        imageInfo.sampler = nullptr;
-
-        std::vector<VkWriteDescriptorSet> descriptorWrites{};
-        VkWriteDescriptorSet imageWrite{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        imageWrite.dstSet = computeDescriptorSets[i];
-        imageWrite.dstBinding = 0;
-        imageWrite.dstArrayElement = 0;
-        imageWrite.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        imageWrite.descriptorCount = 1;
-        imageWrite.pImageInfo = &imageInfo;
-        descriptorWrites.push_back(imageWrite);
-
-        vkUpdateDescriptorSets(lveDevice.device(), static_cast<uint32_t>(descriptorWrites.size()), descriptorWrites.data(), 0, nullptr);
-    }
+VkDescriptorSet ComputeScene::createDescriptorSet(uint32_t currentFrame) {
+    VkDescriptorSetLayout layout = pipelines.computePipelines.perlinNoisePipeline.descriptorSetLayout;
+    VkDescriptorSet descriptorSet = frameDescriptorAllocator.allocate(layout);
+
+    ComputeDescriptors descriptors{};
+    descriptors.image = {VK_NULL_HANDLE, computeImages[currentFrame].view, VK_IMAGE_LAYOUT_GENERAL};
+    frameDescriptorAllocator.writeDescriptorSet(descriptorSet, layout, descriptors);
+    return descriptorSet;
 }
 
 void ComputeScene::draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageIndex, uint32_t currentFrame) {
+    // the frame that last used this context has finished, so the set it used can be recycled
+    frameDescriptorAllocator.beginFrame(currentFrame);
+    VkDescriptorSet descriptorSet = createDescriptorSet(currentFrame);
+    if (benchmarkRequested) {
+        benchmarkRequested = false;
+        benchmarkWorkgroups(descriptorSet, currentFrame);
+    }
+
     util::transitionImageLayout(cmd, computeImages[currentFrame].image, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED,
                                 VK_IMAGE_LAYOUT_GENERAL);
 
     vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.computePipelines.perlinNoisePipeline.pipeline);
     vkCmdPushConstants(cmd, pipelines.computePipelines.perlinNoisePipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0,
                        sizeof(PerlinPushConstants), &pushConstants);
-    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.computePipelines.perlinNoisePipeline.layout, 0, 1,
-                            &computeDescriptorSets[currentFrame], 0, nullptr);
-    vkCmdDispatch(cmd, std::ceil(width / 16.0), std::ceil(height / 16.0), 1);
+    frameDescriptorAllocator.bindDescriptorSet(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipelines.computePipelines.perlinNoisePipeline.layout,
+                                               descriptorSet);
+    const PerlinSpecialization &specialization = pipelines.computePipelines.perlinNoiseSpecialization;
+    vkCmdDispatch(cmd, (extent.width + specialization.workgroupWidth - 1) / specialization.workgroupWidth,
+                  (extent.height + specialization.workgroupHeight - 1) / specialization.workgroupHeight, 1);
 
     // copy resulting image to swapchain image
     util::transitionImageLayout(cmd, computeImages[currentFrame].image, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_GENERAL,
@@ -82,9 +94,7 @@ void ComputeScene::draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageI
     util::transitionImageLayout(cmd, swapChain.getImage(imageIndex), swapChain.getSwapChainImageFormat(), VK_IMAGE_LAYOUT_UNDEFINED,
                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-    VkExtent2D srcExtent{.width = static_cast<uint32_t>(width), .height = static_cast<uint32_t>(height)};
-
-    util::copyImageToImage(cmd, computeImages[currentFrame].image, swapChain.getImage(imageIndex), srcExtent,
+    util::copyImageToImage(cmd, computeImages[currentFrame].image, swapChain.getImage(imageIndex), extent,
                            swapChain.getSwapChainExtent());
 
     util::transitionImageLayout(cmd, computeImages[currentFrame].image, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
@@ -98,8 +108,126 @@ void ComputeScene::showSceneGui() {
     ImGui::DragFloat("Scale", (float *)&pushConstants.scale, 0.01f, 0.1f, FLT_MAX, "%.3f", 0);
     ImGui::DragFloat("Offset X", (float *)&pushConstants.offset.x, 0.01f, FLT_MIN, FLT_MAX, "%.3f", 0);
     ImGui::DragFloat("Offset Y", (float *)&pushConstants.offset.y, 0.01f, FLT_MIN, FLT_MAX, "%.3f", 0);
+
+    const PerlinSpecialization &specialization = pipelines.computePipelines.perlinNoiseSpecialization;
+    ImGui::Text("Resolution: %ux%u, workgroup %ux%u, subgroup %u", extent.width, extent.height, specialization.workgroupWidth,
+                specialization.workgroupHeight, lveDevice.getSubgroupSize());
+    if (ImGui::Button("Benchmark workgroups")) {
+        benchmarkRequested = true;
+    }
+    for (const WorkgroupTiming &timing : workgroupTimings) {
+        ImGui::Text("%3ux%-3u %.4f ms per dispatch", timing.size.width, timing.size.height, timing.milliseconds);
+    }
     ImGui::End();
 }
 
+std::vector<VkExtent2D> ComputeScene::getWorkgroupCandidates() {
+    const VkPhysicalDeviceLimits &limits = lveDevice.properties.limits;
+    uint32_t subgroupSize = lveDevice.getSubgroupSize();
+    const PerlinSpecialization &specialization = pipelines.computePipelines.perlinNoiseSpecialization;
+    std::vector<VkExtent2D> shapes = {{specialization.workgroupWidth, specialization.workgroupHeight},
+                                      {8, 8},
+                                      {16, 16},
+                                      {32, 32},
+                                      {32, 8},
+                                      {8, 32},
+                                      {64, 4},
+                                      {4, 64},
+                                      {subgroupSize, 1},
+                                      {1, subgroupSize}};
+
+    std::vector<VkExtent2D> candidates;
+    for (VkExtent2D shape : shapes) {
+        bool supported = shape.width <= limits.maxComputeWorkGroupSize[0] && shape.height <= limits.maxComputeWorkGroupSize[1] &&
+                         shape.width * shape.height <= limits.maxComputeWorkGroupInvocations;
+        bool duplicate = std::any_of(candidates.begin(), candidates.end(), [shape](VkExtent2D candidate) {
+            return candidate.width == shape.width && candidate.height == shape.height;
+        });
+        if (supported && !duplicate) {
+            candidates.push_back(shape);
+        }
+    }
+    return candidates;
+}
+
+void ComputeScene::benchmarkWorkgroups(VkDescriptorSet descriptorSet, uint32_t currentFrame) {
+    workgroupTimings.clear();
+    const VkPhysicalDeviceLimits &limits = lveDevice.properties.limits;
+    if (!limits.timestampComputeAndGraphics) {
+        std::cerr << "workgroup benchmark skipped, the device has no compute timestamps" << std::endl;
+        return;
+    }
+
+    // every shape is its own specialization of the pipeline, built before recording
+    const Pipeline &perlinNoisePipeline = pipelines.computePipelines.perlinNoisePipeline;
+    std::vector<VkExtent2D> shapes = getWorkgroupCandidates();
+    std::vector<PipelineId> shapeIds;
+    std::vector<VkPipeline> shapePipelines;
+    for (VkExtent2D shape : shapes) {
+        PerlinSpecialization specialization = pipelines.computePipelines.perlinNoiseSpecialization;
+        specialization.workgroupWidth = shape.width;
+        specialization.workgroupHeight = shape.height;
+        PipelineId id = init::specializePerlinNoisePipeline(&lveDevice, perlinNoisePipeline, specialization);
+        shapeIds.push_back(id);
+        shapePipelines.push_back(lveDevice.pipelineRegistry().getHandle(id));
+    }
+
+    uint32_t queryCount = static_cast<uint32_t>(2 * shapes.size());
+    VkQueryPoolCreateInfo queryPoolInfo{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO};
+    queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    queryPoolInfo.queryCount = queryCount;
+    VkQueryPool queryPool;
+    if (vkCreateQueryPool(lveDevice.device(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create query pool!");
+    }
+
+    VkCommandBuffer cmd = lveDevice.beginSingleTimeCommands();
+    if (lveDevice.isDescriptorBufferEnabled()) {
+        lveDevice.descriptorBuffer().bindBuffer(cmd);
+    }
+    vkCmdResetQueryPool(cmd, queryPool, 0, queryCount);
+    util::transitionImageLayout(cmd, computeImages[currentFrame].image, VK_FORMAT_B8G8R8A8_UNORM, VK_IMAGE_LAYOUT_UNDEFINED,
+                                VK_IMAGE_LAYOUT_GENERAL);
+    vkCmdPushConstants(cmd, perlinNoisePipeline.layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PerlinPushConstants), &pushConstants);
+    frameDescriptorAllocator.bindDescriptorSet(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, perlinNoisePipeline.layout, descriptorSet);
+
+    // dispatches write the same image, the barrier keeps them from overlapping so each one is timed whole
+    VkMemoryBarrier barrier{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER};
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    for (size_t i = 0; i < shapes.size(); i++) {
+        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, shapePipelines[i]);
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, static_cast<uint32_t>(2 * i));
+        for (uint32_t dispatch = 0; dispatch < BENCHMARK_DISPATCHES; dispatch++) {
+            vkCmdDispatch(cmd, (extent.width + shapes[i].width - 1) / shapes[i].width,
+                          (extent.height + shapes[i].height - 1) / shapes[i].height, 1);
+            vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &barrier, 0,
+                                 nullptr, 0, nullptr);
+        }
+        vkCmdWriteTimestamp(cmd, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, static_cast<uint32_t>(2 * i + 1));
+    }
+    lveDevice.endSingleTimeCommands(cmd);
+
+    // the registry keys them by the current shader modules and layout, which a reload destroys.
+    // The current shape resolves to the pipeline the scene draws with, which stays
+    for (PipelineId id : shapeIds) {
+        if (id != perlinNoisePipeline.id) {
+            lveDevice.pipelineRegistry().releasePipeline(id);
+        }
+    }
+
+    std::vector<uint64_t> timestamps(queryCount);
+    vkGetQueryPoolResults(lveDevice.device(), queryPool, 0, queryCount, timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                          sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+    vkDestroyQueryPool(lveDevice.device(), queryPool, nullptr);
+
+    for (size_t i = 0; i < shapes.size(); i++) {
+        double nanoseconds = static_cast<double>(timestamps[2 * i + 1] - timestamps[2 * i]) * limits.timestampPeriod;
+        workgroupTimings.push_back({shapes[i], static_cast<float>(nanoseconds / 1e6 / BENCHMARK_DISPATCHES)});
+    }
+    std::sort(workgroupTimings.begin(), workgroupTimings.end(),
+              [](const WorkgroupTiming &a, const WorkgroupTiming &b) { return a.milliseconds < b.milliseconds; });
+}
+
 void ComputeScene::updateUniformBuffer(uint32_t currentImage, uint32_t width, uint32_t height) {}
 } // namespace lve
\ No newline at end of file
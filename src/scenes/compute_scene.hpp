@@ -1,27 +1,50 @@
 #include "../scene.hpp"
 
 namespace lve {
+// the storage image set of the perlin noise pipeline
+struct ComputeDescriptors {
+    VkDescriptorImageInfo image;
+
+    static const std::vector<DescriptorTemplateEntry> &templateEntries();
+};
+
 class ComputeScene : public IScene {
 public:
-    ComputeScene(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window);
+    ComputeScene(LveDevice &device, ApplicationPipelines &pipelines, util::ThreadPool &threadPool, AssetCache &assetCache,
+                 GLFWwindow *window);
     ~ComputeScene();
     void initScene();
     void destroyScene();
     void draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageIndex, uint32_t currentFrame);
     void showSceneGui();
     void updateUniformBuffer(uint32_t currentImage, uint32_t width, uint32_t height);
+    std::vector<PipelineGroup> getRequiredPipelines() { return {PipelineGroup::Compute}; }
 
 protected:
     virtual void createDescriptorPool();
-    void createDescriptorSets();
+    VkDescriptorSet createDescriptorSet(uint32_t currentFrame);
     void createComputeImages();
+    // times every workgroup shape the device allows on the frame's image, waits for the GPU
+    void benchmarkWorkgroups(VkDescriptorSet descriptorSet, uint32_t currentFrame);
+    std::vector<VkExtent2D> getWorkgroupCandidates();
 
 private:
-    const int width = 1600;
-    const int height = 900;
+    // averaged over this many dispatches per workgroup shape
+    static constexpr uint32_t BENCHMARK_DISPATCHES = 32;
+
+    struct WorkgroupTiming {
+        VkExtent2D size;
+        float milliseconds;
+    };
+
+    // the resolution the pipeline was specialized for
+    VkExtent2D extent{};
+    bool benchmarkRequested = false;
+    std::vector<WorkgroupTiming> workgroupTimings;
 
     PerlinPushConstants pushConstants{};
     std::vector<AllocatedImage> computeImages;
-    std::vector<VkDescriptorSet> computeDescriptorSets;
+    // the storage image set is rewritten every frame from a per-frame pool
+    FrameDescriptorAllocator frameDescriptorAllocator{lveDevice};
 };
 } // namespace lve
\ No newline at end of file
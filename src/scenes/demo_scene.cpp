@@ -1,40 +1,86 @@
 #include "demo_scene.hpp"
 #include "imgui.h"
 
-#include "../initializers/images.hpp"
+#include "../shader_permutation.hpp"
 #include "../utility/images.hpp"
 
+#include <bit>
 #include <chrono>
+#include <cstring>
 #include <iostream>
-#include <ranges>
 
 namespace lve {
-DemoScene::DemoScene(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window) : IScene{device, pipelines, window} {
+DemoScene::DemoScene(LveDevice &device, ApplicationPipelines &pipelines, util::ThreadPool &threadPool, AssetCache &assetCache,
+                     GLFWwindow *window)
+    : IScene{device, pipelines, threadPool, assetCache, window} {
     sceneName = "Demo Scene";
 }
 
 DemoScene::~DemoScene() {}
 
 void DemoScene::initScene() {
-    init::createImageSampler(lveDevice.device(), lveDevice.properties.limits.maxSamplerAnisotropy, textureSampler);
-    createDescriptorPool();
+    parallelRecorder = std::make_unique<ParallelRecorder>(lveDevice);
+    if (pipelines.bindless) {
+        bindlessSet = std::make_unique<BindlessSet>(lveDevice, pipelines.bindlessOpaquePipeline.descriptorSetLayout);
+    } else {
+        // push descriptors need no sets
+        if (!lveDevice.isPushDescriptorEnabled()) {
+            createDescriptorPool();
+        }
+        createUniformBuffers();
+    }
     loadTextureImages();
     loadModels();
 }
 
 void DemoScene::destroyScene() {
-    descriptorAllocator.destroyDescriptorPool();
-    vkDestroySampler(lveDevice.device(), textureSampler, nullptr);
-    destroyImage(lveDevice.device(), roomTextureImage);
-    destroyImage(lveDevice.device(), cubeTextureImage);
+    // textures and meshes go back to the asset cache and stay resident for the next visit
+    pipelineToModelMap.clear();
+    descriptorSetCache.clear();
+    destroyUniformBuffers();
+    roomTexture.reset();
+    cubeTexture.reset();
+    textureAtlas.reset();
+    textureStreamer.reset();
+    bindlessSet.reset();
+    descriptorAllocator.destroyDescriptorPools();
+    parallelRecorder.reset();
 }
 
 void DemoScene::createDescriptorPool() {
+    // every model set holds one uniform buffer and one texture, more pools are chained as models are added
+    const uint32_t maxSets = 10;
     std::vector<VkDescriptorPoolSize> poolSizes{};
-    poolSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, static_cast<uint32_t>(LveSwapChain::MAX_FRAMES_IN_FLIGHT)});
-    poolSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, static_cast<uint32_t>(LveSwapChain::MAX_FRAMES_IN_FLIGHT)});
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, maxSets});
+    poolSizes.push_back({VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, maxSets});
+
+    descriptorAllocator.createDescriptorPool(poolSizes, maxSets);
+}
+
+void DemoScene::createUniformBuffers() {
+    VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
-    descriptorAllocator.createDescriptorPool(poolSizes, 10);
+    uniformBuffers.resize(lveDevice.getFramesInFlight());
+    uniformBuffersMemory.resize(lveDevice.getFramesInFlight());
+    uniformBuffersMapped.resize(lveDevice.getFramesInFlight());
+
+    for (size_t i = 0; i < lveDevice.getFramesInFlight(); i++) {
+        lveDevice.createBuffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
+                               VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, uniformBuffers[i],
+                               uniformBuffersMemory[i]);
+
+        vkMapMemory(lveDevice.device(), uniformBuffersMemory[i], 0, bufferSize, 0, &uniformBuffersMapped[i]);
+    }
+}
+
+void DemoScene::destroyUniformBuffers() {
+    for (size_t i = 0; i < uniformBuffers.size(); i++) {
+        vkDestroyBuffer(lveDevice.device(), uniformBuffers[i], nullptr);
+        vkFreeMemory(lveDevice.device(), uniformBuffersMemory[i], nullptr);
+    }
+    uniformBuffers.clear();
+    uniformBuffersMemory.clear();
+    uniformBuffersMapped.clear();
 }
 
 void DemoScene::draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageIndex, uint32_t currentFrame) {
@@ -59,6 +105,8 @@ void DemoScene::draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageInde
     renderingInfo.pColorAttachments = &colorAttachment;
     renderingInfo.pDepthAttachment = &depthAttachment;
     renderingInfo.pStencilAttachment = nullptr;
+    // the draws are recorded into secondaries on the recorder's threads
+    renderingInfo.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT;
     vkCmdBeginRendering(cmd, &renderingInfo);
 
     VkViewport viewport = {};
@@ -69,31 +117,91 @@ void DemoScene::draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageInde
     viewport.minDepth = 0.0f;
     viewport.maxDepth = 1.0f;
 
-    vkCmdSetViewport(cmd, 0, 1, &viewport);
-
     VkRect2D scissor = {};
     scissor.offset.x = 0;
     scissor.offset.y = 0;
     scissor.extent.width = swapChain.getSwapChainExtent().width;
     scissor.extent.height = swapChain.getSwapChainExtent().height;
 
-    vkCmdSetScissor(cmd, 0, 1, &scissor);
-
     TransparentPushConstants defaultPushConstants{};
     defaultPushConstants.color = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
 
-    for (auto pipeline : std::views::keys(pipelineToModelMap)) {
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline.pipeline);
-        TransparentPushConstants *constants = pipeline.transparent ? &pushConstants : &defaultPushConstants;
-        for (auto &model : pipelineToModelMap[pipeline]) {
-            model->bind(cmd, pipeline.layout, currentFrame);
-            vkCmdPushConstants(cmd, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransparentPushConstants), constants);
-            model->draw(cmd);
-        }
+    parallelRecorder->beginFrame(currentFrame);
+    if (bindlessSet) {
+        textureStreamer->update(currentFrame);
+        bindlessSet->writePendingTextures(currentFrame);
     }
 
+    // the registry may have swapped a fast linked pipeline for its optimized one since the last frame
+    PipelineRegistry &pipelineRegistry = lveDevice.pipelineRegistry();
+
+    // the scene is repeated until it reaches benchmarkDraws, to compare record times of the descriptor paths
+    // and thread counts. Everything the recording threads would have to look up is resolved here first
+    auto recordStart = std::chrono::steady_clock::now();
+    draws.clear();
+    do {
+        for (auto &[pipeline, models] : pipelineToModelMap) {
+            VkPipeline handle = pipelineRegistry.getHandle(pipeline.id);
+            const TransparentPushConstants *constants = pipeline.transparent ? &pushConstants : &defaultPushConstants;
+            for (auto &model : models) {
+                model->prepareBind(pipeline.layout);
+                draws.push_back({&pipeline, handle, model.get(), constants});
+            }
+        }
+    } while (!draws.empty() && draws.size() < static_cast<size_t>(benchmarkDraws));
+
+    VkFormat colorFormat = swapChain.getSwapChainImageFormat();
+    VkCommandBufferInheritanceRenderingInfo inheritanceInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO};
+    inheritanceInfo.colorAttachmentCount = 1;
+    inheritanceInfo.pColorAttachmentFormats = &colorFormat;
+    inheritanceInfo.depthAttachmentFormat = swapChain.getSwapChainDepthFormat();
+    inheritanceInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+    parallelRecorder->record(cmd, inheritanceInfo, static_cast<uint32_t>(draws.size()),
+                             [&](VkCommandBuffer secondary, uint32_t first, uint32_t last) {
+        vkCmdSetViewport(secondary, 0, 1, &viewport);
+        vkCmdSetScissor(secondary, 0, 1, &scissor);
+        if (bindlessSet) {
+            // both bindless pipelines share a layout, so the set stays bound across pipeline changes
+            bindlessSet->bind(secondary, pipelines.bindlessOpaquePipeline.layout, currentFrame);
+        }
+
+        const Pipeline *boundPipeline = nullptr;
+        for (uint32_t i = first; i < last; i++) {
+            const Draw &item = draws[i];
+            const Pipeline &pipeline = *item.pipeline;
+            if (item.pipeline != boundPipeline) {
+                // opaque and transparent batches may bind the same pipeline and differ only in this state
+                vkCmdBindPipeline(secondary, VK_PIPELINE_BIND_POINT_GRAPHICS, item.handle);
+                lveDevice.dynamicState().apply(secondary, pipeline.renderState);
+                boundPipeline = item.pipeline;
+            }
+            item.model->bind(secondary, pipeline.layout, currentFrame);
+            if (bindlessSet) {
+                BindlessPushConstants bindlessConstants{modelTransform, item.constants->color, item.model->getUvTransform(),
+                                                        item.model->getTextureIndex()};
+                vkCmdPushConstants(secondary, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+                                   sizeof(BindlessPushConstants), &bindlessConstants);
+            } else {
+                TransparentPushConstants modelConstants = *item.constants;
+                modelConstants.uvTransform = item.model->getUvTransform();
+                vkCmdPushConstants(secondary, pipeline.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(TransparentPushConstants),
+                                   &modelConstants);
+            }
+            item.model->draw(secondary);
+        }
+    });
+    auto recordEnd = std::chrono::steady_clock::now();
+    float recordTime = std::chrono::duration<float, std::chrono::milliseconds::period>(recordEnd - recordStart).count();
+    recordMilliseconds = recordMilliseconds * 0.95f + recordTime * 0.05f;
+    recordedDraws = static_cast<uint32_t>(draws.size());
+
     vkCmdEndRendering(cmd);
 
+    if (bindlessSet) {
+        bindlessSet->recordFeedbackBarrier(cmd);
+    }
+
     util::transitionImageLayout(cmd, swapChain.getImage(imageIndex), swapChain.getSwapChainImageFormat(), VK_IMAGE_LAYOUT_UNDEFINED,
                                 VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 }
@@ -102,7 +210,55 @@ void DemoScene::showSceneGui() {
     ImGui::Begin("Cube Color");
     static ImVec4 color = ImVec4(114.0f / 255.0f, 144.0f / 255.0f, 154.0f / 255.0f, 200.0f / 255.0f);
     ImGui::ColorEdit4("Cube Color", (float *)&pushConstants.color);
+    const char *descriptorPath = "per model";
+    if (bindlessSet) {
+        descriptorPath = "bindless";
+    } else if (lveDevice.isPushDescriptorEnabled()) {
+        descriptorPath = "per model, push descriptors";
+    } else if (descriptorAllocator.usesDescriptorBuffer()) {
+        descriptorPath = "per model, descriptor buffer";
+    }
+    ImGui::Text("Frames in flight: %u", lveDevice.getFramesInFlight());
+    ImGui::Text("Descriptors: %s", descriptorPath);
+    ImGui::Text("Atlas: %zu textures in %zu pages", textureAtlas->getEntryCount(), textureAtlas->getPageCount());
+    DescriptorLayoutCache &layoutCache = lveDevice.descriptorLayoutCache();
+    ImGui::Text("Set layouts: %zu, %llu hits, %llu misses", layoutCache.size(), static_cast<unsigned long long>(layoutCache.getHits()),
+                static_cast<unsigned long long>(layoutCache.getMisses()));
+    ImGui::Text("Descriptor sets: %zu, %llu hits, %llu misses", descriptorSetCache.size(),
+                static_cast<unsigned long long>(descriptorSetCache.getHits()),
+                static_cast<unsigned long long>(descriptorSetCache.getMisses()));
+    PipelineCache &pipelineCache = lveDevice.pipelineCache();
+    ImGui::Text("Pipelines: %llu built, %llu cache hits, %.1f ms", static_cast<unsigned long long>(pipelineCache.getPipelineCount()),
+                static_cast<unsigned long long>(pipelineCache.getHits()), pipelineCache.getCreationMilliseconds());
+    PipelineRegistry &pipelineRegistry = lveDevice.pipelineRegistry();
+    ImGui::Text("Pipeline states: %zu, %llu hits", pipelineRegistry.size(),
+                static_cast<unsigned long long>(pipelineRegistry.getHits()));
+    if (!pipelines.bindless) {
+        // the first variant has every declared feature
+        uint32_t possibleVariants = 1u << std::popcount(pipelines.graphicsVariants[0].features);
+        ImGui::Text("Shader variants: %zu of %u", pipelines.graphicsVariants.size(), possibleVariants);
+        for (auto &[pipeline, models] : pipelineToModelMap) {
+            ImGui::BulletText("%s: %zu models", ShaderPermutations::getName(pipeline.features).c_str(), models.size());
+        }
+    }
+    if (lveDevice.isGraphicsPipelineLibraryEnabled()) {
+        ImGui::Text("Pipeline libraries: %zu, %llu links optimized", pipelineRegistry.getLibraryCount(),
+                    static_cast<unsigned long long>(pipelineRegistry.getOptimizedCount()));
+    }
+    DynamicState &dynamicState = lveDevice.dynamicState();
+    ImGui::Text("Dynamic state: cull/depth %s, blend %s", dynamicState.isDepthCullDynamic() ? "yes" : "no",
+                dynamicState.isBlendDynamic() ? "yes" : "no");
+    ImGui::SliderInt("Benchmark draws", &benchmarkDraws, 0, 50000);
+    int recordThreads = static_cast<int>(parallelRecorder->getThreadCount());
+    if (ImGui::SliderInt("Record threads", &recordThreads, 1, static_cast<int>(parallelRecorder->getMaxThreadCount()))) {
+        parallelRecorder->setThreadCount(static_cast<uint32_t>(recordThreads));
+    }
+    ImGui::Text("Record: %.3f ms for %u draws on %u threads", recordMilliseconds, recordedDraws,
+                parallelRecorder->getUsedThreadCount());
     ImGui::End();
+    if (textureStreamer) {
+        textureStreamer->showGui();
+    }
     camera.ShowParameterGui();
 }
 
@@ -123,25 +279,51 @@ void DemoScene::updateUniformBuffer(uint32_t currentImage, uint32_t width, uint3
     // flip Y clip coordinate
     ubo.proj[1][1] *= -1;
 
-    for (auto pipeline : std::views::keys(pipelineToModelMap)) {
-        for (auto &model : pipelineToModelMap[pipeline]) {
-            model->updateUniformBuffer(ubo, currentImage);
-        }
+    if (bindlessSet) {
+        modelTransform = ubo.model;
+        bindlessSet->updateUniformBuffer({ubo.view, ubo.proj}, currentImage);
+        return;
     }
+
+    memcpy(uniformBuffersMapped[currentImage], &ubo, sizeof(ubo));
 }
 
 void DemoScene::loadTextureImages() {
-    util::loadTextureImage(&lveDevice, ROOM_TEXTURE_PATH, roomTextureImage);
-    util::loadTextureImage(&lveDevice, CUBE_TEXTURE_PATH, cubeTextureImage);
+    textureAtlas = assetCache.acquireAtlas({CUBE_TEXTURE_PATH});
+    cubeTexture = textureAtlas->getRegion(CUBE_TEXTURE_PATH).page;
+
+    if (bindlessSet) {
+        // only the room texture's low mips are resident until the GPU asks for more
+        textureStreamer = std::make_unique<TextureStreamer>(lveDevice, threadPool, assetCache, *bindlessSet);
+        roomTextureIndex = textureStreamer->addTexture(ROOM_TEXTURE_PATH);
+        return;
+    }
+
+    roomTexture = assetCache.acquireTexture(ROOM_TEXTURE_PATH);
 }
 
 void DemoScene::loadModels() {
     std::vector<std::unique_ptr<Model>> models;
 
-    models.push_back(std::make_unique<Model>(lveDevice, pipelines.opaquePipeline, descriptorAllocator, roomTextureImage.view,
-                                             textureSampler, ROOM_MODEL_PATH));
-    models.push_back(std::make_unique<Model>(lveDevice, pipelines.transparentPipeline, descriptorAllocator, cubeTextureImage.view,
-                                             textureSampler, CUBE_MODEL_PATH));
+    if (bindlessSet) {
+        models.push_back(std::make_unique<Model>(lveDevice, pipelines.bindlessOpaquePipeline, nullptr, roomTextureIndex,
+                                                 assetCache.acquireMesh(ROOM_MODEL_PATH)));
+        models.push_back(std::make_unique<Model>(lveDevice, pipelines.bindlessTransparentPipeline, cubeTexture,
+                                                 bindlessSet->registerTexture(*cubeTexture), assetCache.acquireMesh(CUBE_MODEL_PATH)));
+    } else {
+        // each material takes the leanest shader variant it can, the cube's white texture is not sampled
+        std::shared_ptr<Mesh> roomMesh = assetCache.acquireMesh(ROOM_MODEL_PATH);
+        std::shared_ptr<Mesh> cubeMesh = assetCache.acquireMesh(CUBE_MODEL_PATH);
+        ShaderFeatures roomFeatures = SHADER_FEATURE_TEXTURED | (roomMesh->hasVertexColors() ? SHADER_FEATURE_VERTEX_COLOR : 0);
+        ShaderFeatures cubeFeatures = SHADER_FEATURE_ALPHA_BLEND | (cubeMesh->hasVertexColors() ? SHADER_FEATURE_VERTEX_COLOR : 0);
+        models.push_back(std::make_unique<Model>(lveDevice, selectPipelineVariant(pipelines.graphicsVariants, roomFeatures),
+                                                 descriptorSetCache, uniformBuffers, roomTexture, roomMesh));
+        models.push_back(std::make_unique<Model>(lveDevice, selectPipelineVariant(pipelines.graphicsVariants, cubeFeatures),
+                                                 descriptorSetCache, uniformBuffers, cubeTexture, cubeMesh));
+    }
+
+    // the cube is the second model on either path
+    models[1]->setUvTransform(textureAtlas->getRegion(CUBE_TEXTURE_PATH).uvTransform);
 
     for (auto &model : models) {
         pipelineToModelMap[model->getDrawPipeline()].push_back(std::move(model));
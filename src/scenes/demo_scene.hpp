@@ -1,18 +1,29 @@
+#include "../bindless_set.hpp"
+#include "../descriptor_set_cache.hpp"
+#include "../parallel_recorder.hpp"
 #include "../scene.hpp"
+#include "../texture_atlas.hpp"
+#include "../texture_streamer.hpp"
 
 namespace lve {
 class DemoScene : public IScene {
 public:
-    DemoScene(LveDevice &device, ApplicationPipelines &pipelines, GLFWwindow *window);
+    DemoScene(LveDevice &device, ApplicationPipelines &pipelines, util::ThreadPool &threadPool, AssetCache &assetCache,
+              GLFWwindow *window);
     ~DemoScene();
     void draw(VkCommandBuffer cmd, LveSwapChain &swapChain, int imageIndex, uint32_t currentFrame);
     void showSceneGui();
     void updateUniformBuffer(uint32_t currentImage, uint32_t width, uint32_t height);
+    std::vector<PipelineGroup> getRequiredPipelines() {
+        return {pipelines.bindless ? PipelineGroup::Bindless : PipelineGroup::Graphics};
+    }
 
 protected:
     void initScene();
     void destroyScene();
     void createDescriptorPool();
+    void createUniformBuffers();
+    void destroyUniformBuffers();
     void loadModels();
     void loadTextureImages();
 
@@ -23,9 +34,40 @@ private:
     const std::string CUBE_TEXTURE_PATH = "resources/textures/white.png";
 
     TransparentPushConstants pushConstants{};
+    // bindless only, set by updateUniformBuffer before the frame is recorded
+    glm::mat4 modelTransform{1.0f};
 
-    AllocatedImage roomTextureImage;
-    AllocatedImage cubeTextureImage;
-    VkSampler textureSampler;
+    // one entry per draw call, resolved on the render thread and split between the recording threads
+    struct Draw {
+        const Pipeline *pipeline;
+        VkPipeline handle;
+        Model *model;
+        const TransparentPushConstants *constants;
+    };
+
+    // draw recording benchmark, the record time is averaged over recent frames
+    int benchmarkDraws = 0;
+    uint32_t recordedDraws = 0;
+    float recordMilliseconds = 0.0f;
+    std::vector<Draw> draws;
+    std::unique_ptr<ParallelRecorder> parallelRecorder;
+
+    // per model path, one uniform buffer per frame shared by every model
+    DescriptorSetCache descriptorSetCache{descriptorAllocator};
+    std::vector<VkBuffer> uniformBuffers;
+    std::vector<VkDeviceMemory> uniformBuffersMemory;
+    std::vector<void *> uniformBuffersMapped;
+
+    // set when the bindless pipelines exist, models then share one set per frame
+    std::unique_ptr<BindlessSet> bindlessSet;
+    // bindless only, the room texture streams its finer mips on top of a tail from the asset cache
+    std::unique_ptr<TextureStreamer> textureStreamer;
+    uint32_t roomTextureIndex = 0;
+    // small textures share atlas pages, the cube samples its region through a uv transform. The atlas
+    // belongs to the asset cache, so revisiting the scene does not pack it again
+    std::shared_ptr<TextureAtlas> textureAtlas;
+
+    std::shared_ptr<AllocatedImage> roomTexture;
+    std::shared_ptr<AllocatedImage> cubeTexture;
 };
 } // namespace lve
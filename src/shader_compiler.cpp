@@ -0,0 +1,265 @@
+#include "shader_compiler.hpp"
+
+#ifdef LVE_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+// std
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+
+namespace lve {
+namespace {
+// a source's dependencies are recorded per set of defines, permutations may include different files
+std::string definesKey(const std::vector<std::string> &defines) {
+    std::string key;
+    for (const std::string &define : defines) {
+        key += define + ";";
+    }
+    return key;
+}
+
+#ifdef LVE_SHADERC
+// every option compile sets, they are part of the cache key so changing one recompiles
+constexpr shaderc_env_version TARGET_ENV_VERSION = shaderc_env_version_vulkan_1_3;
+constexpr shaderc_optimization_level OPTIMIZATION_LEVEL = shaderc_optimization_level_performance;
+constexpr bool GENERATE_DEBUG_INFO = false;
+
+std::string optionsKey() {
+    // the SPIR-V version shaderc generates stands in for its own version, which it does not report
+    unsigned int spirvVersion = 0;
+    unsigned int spirvRevision = 0;
+    shaderc_get_spv_version(&spirvVersion, &spirvRevision);
+    return "env " + std::to_string(static_cast<int>(TARGET_ENV_VERSION)) + " opt " +
+           std::to_string(static_cast<int>(OPTIMIZATION_LEVEL)) + " debug " + std::to_string(GENERATE_DEBUG_INFO) +
+           " spirv " + std::to_string(spirvVersion) + "." + std::to_string(spirvRevision);
+}
+
+// FNV-1a, stable across runs and platforms so the cache file names are too
+uint64_t hashBytes(uint64_t seed, const std::string &bytes) {
+    for (unsigned char byte : bytes) {
+        seed = (seed ^ byte) * 0x100000001b3;
+    }
+    return seed;
+}
+
+std::string readText(const std::string &filePath) {
+    std::ifstream file{filePath, std::ios::binary};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filePath);
+    }
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+shaderc_shader_kind shaderKind(const std::string &sourcePath) {
+    std::string extension = std::filesystem::path{sourcePath}.extension().string();
+    if (extension == ".vert") {
+        return shaderc_vertex_shader;
+    }
+    if (extension == ".frag") {
+        return shaderc_fragment_shader;
+    }
+    if (extension == ".comp") {
+        return shaderc_compute_shader;
+    }
+    throw std::runtime_error("failed to compile shader, unknown stage: " + sourcePath);
+}
+
+// resolves #include "file" against the including file's directory and records what was read
+class Includer : public shaderc::CompileOptions::IncluderInterface {
+public:
+    explicit Includer(std::vector<std::string> &includedFiles) : includedFiles{includedFiles} {}
+
+    shaderc_include_result *GetInclude(const char *requestedSource, shaderc_include_type type, const char *requestingSource,
+                                       size_t includeDepth) override {
+        auto include = std::make_unique<Include>();
+        std::filesystem::path path = requestedSource;
+        if (type == shaderc_include_type_relative) {
+            path = std::filesystem::path{requestingSource}.parent_path() / path;
+        }
+        std::ifstream file{path, std::ios::binary};
+        if (file.is_open()) {
+            std::stringstream text;
+            text << file.rdbuf();
+            include->name = path.lexically_normal().generic_string();
+            include->content = text.str();
+            includedFiles.push_back(include->name);
+        } else {
+            // an empty name reports the content as the error
+            include->content = "failed to open include: " + path.generic_string();
+        }
+
+        include->result.source_name = include->name.c_str();
+        include->result.source_name_length = include->name.size();
+        include->result.content = include->content.c_str();
+        include->result.content_length = include->content.size();
+        include->result.user_data = include.get();
+        return &include.release()->result;
+    }
+
+    void ReleaseInclude(shaderc_include_result *data) override { delete static_cast<Include *>(data->user_data); }
+
+private:
+    struct Include {
+        shaderc_include_result result{};
+        std::string name;
+        std::string content;
+    };
+
+    std::vector<std::string> &includedFiles;
+};
+#endif
+} // namespace
+
+ShaderCompiler::ShaderCompiler(const std::string &cacheDirectory) : cacheDirectory{cacheDirectory} {
+#ifdef LVE_SHADERC
+    std::filesystem::create_directories(cacheDirectory);
+#endif
+}
+
+#ifdef LVE_SHADERC
+std::vector<uint32_t> ShaderCompiler::compile(const std::string &sourcePath, const std::vector<std::string> &defines) {
+    shaderc_shader_kind kind = shaderKind(sourcePath);
+    std::string source = readText(sourcePath);
+
+    std::vector<std::string> files{sourcePath};
+    shaderc::CompileOptions options;
+    options.SetTargetEnvironment(shaderc_target_env_vulkan, TARGET_ENV_VERSION);
+    options.SetOptimizationLevel(OPTIMIZATION_LEVEL);
+    if (GENERATE_DEBUG_INFO) {
+        options.SetGenerateDebugInfo();
+    }
+    options.SetIncluder(std::make_unique<Includer>(files));
+    for (const std::string &define : defines) {
+        size_t separator = define.find('=');
+        if (separator == std::string::npos) {
+            options.AddMacroDefinition(define);
+        } else {
+            options.AddMacroDefinition(define.substr(0, separator), define.substr(separator + 1));
+        }
+    }
+
+    // includes are resolved by the preprocessor, so its output covers every file the shader reads
+    shaderc::Compiler compiler;
+    shaderc::PreprocessedSourceCompilationResult preprocessed = compiler.PreprocessGlsl(source, kind, sourcePath.c_str(), options);
+    if (preprocessed.GetCompilationStatus() != shaderc_compilation_status_success) {
+        throw std::runtime_error("failed to preprocess shader: " + preprocessed.GetErrorMessage());
+    }
+    std::string preprocessedSource{preprocessed.cbegin(), preprocessed.cend()};
+
+    uint64_t hash = hashBytes(0xcbf29ce484222325, preprocessedSource);
+    hash = hashBytes(hash, std::to_string(static_cast<int>(kind)));
+    hash = hashBytes(hash, optionsKey());
+    for (const std::string &define : defines) {
+        hash = hashBytes(hash, define);
+    }
+    char hashText[17];
+    snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(hash));
+    std::string cachePath = cacheDirectory + "/" + std::filesystem::path{sourcePath}.filename().string() + "." + hashText + ".spv";
+
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        dependencies[sourcePath][definesKey(defines)] = files;
+    }
+
+    if (std::filesystem::exists(cachePath)) {
+        std::lock_guard<std::mutex> lock{mutex};
+        cacheHits++;
+    } else {
+        shaderc::SpvCompilationResult result = compiler.CompileGlslToSpv(preprocessedSource, kind, sourcePath.c_str(), options);
+        if (result.GetCompilationStatus() != shaderc_compilation_status_success) {
+            throw std::runtime_error("failed to compile shader: " + result.GetErrorMessage());
+        }
+        std::vector<uint32_t> code{result.cbegin(), result.cend()};
+        writeSpirv(cachePath, code);
+
+        std::lock_guard<std::mutex> lock{mutex};
+        compileCount++;
+        return code;
+    }
+    return readSpirv(cachePath);
+}
+
+void ShaderCompiler::writeSpirv(const std::string &filePath, const std::vector<uint32_t> &code) {
+    // written under a temporary name first, a reader never sees a partial file. Pool threads may
+    // compile the same variant at once, each writes its own temporary file
+    std::string tempPath = filePath + "." + std::to_string(tempFileCount++) + ".tmp";
+    {
+        std::ofstream file{tempPath, std::ios::binary | std::ios::trunc};
+        if (!file.is_open()) {
+            throw std::runtime_error("failed to write shader cache: " + tempPath);
+        }
+        file.write(reinterpret_cast<const char *>(code.data()), code.size() * sizeof(uint32_t));
+    }
+    std::filesystem::rename(tempPath, filePath);
+}
+#else
+std::vector<uint32_t> ShaderCompiler::compile(const std::string &sourcePath, const std::vector<std::string> &defines) {
+    // shader permutations are compiled by compile.sh, one file per set of defines
+    std::string spirvPath = sourcePath;
+    for (const std::string &define : defines) {
+        if (define.find('=') != std::string::npos) {
+            throw std::runtime_error("failed to compile " + sourcePath + ", define values need runtime shader compilation");
+        }
+        spirvPath += "." + define;
+    }
+    spirvPath += ".spv";
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        dependencies[sourcePath][definesKey(defines)] = {spirvPath};
+        cacheHits++;
+    }
+    return readSpirv(spirvPath);
+}
+#endif
+
+std::vector<uint32_t> ShaderCompiler::readSpirv(const std::string &filePath) {
+    std::ifstream file{filePath, std::ios::ate | std::ios::binary};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + filePath);
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize == 0 || fileSize % sizeof(uint32_t) != 0) {
+        throw std::runtime_error("failed to read SPIR-V, bad file size: " + filePath);
+    }
+    std::vector<uint32_t> code(fileSize / sizeof(uint32_t));
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(code.data()), fileSize);
+    return code;
+}
+
+std::vector<std::string> ShaderCompiler::getDependencies(const std::string &sourcePath) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto it = dependencies.find(sourcePath);
+    if (it == dependencies.end()) {
+        return {};
+    }
+    std::vector<std::string> files;
+    for (auto &[defines, variantFiles] : it->second) {
+        for (const std::string &file : variantFiles) {
+            if (std::find(files.begin(), files.end(), file) == files.end()) {
+                files.push_back(file);
+            }
+        }
+    }
+    return files;
+}
+
+uint64_t ShaderCompiler::getCompileCount() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return compileCount;
+}
+
+uint64_t ShaderCompiler::getCacheHits() {
+    std::lock_guard<std::mutex> lock{mutex};
+    return cacheHits;
+}
+} // namespace lve
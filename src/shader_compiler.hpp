@@ -0,0 +1,46 @@
+#pragma once
+
+// std
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Compiles GLSL under shaders/ to SPIR-V at runtime with shaderc. Compiled code is cached on disk,
+// keyed by a hash of the preprocessed source, so a file only compiles again when it or one of its
+// includes changed. Without shaderc (SHADERC=0 in the Makefile) the .spv written by compile.sh next
+// to the source is loaded instead, simple_shader.frag.TEXTURED.spv for the define TEXTURED, and
+// defines with a value are not supported.
+class ShaderCompiler {
+public:
+    explicit ShaderCompiler(const std::string &cacheDirectory);
+
+    ShaderCompiler(const ShaderCompiler &) = delete;
+    ShaderCompiler &operator=(const ShaderCompiler &) = delete;
+
+    // the stage comes from the extension, defines are NAME or NAME=VALUE
+    std::vector<uint32_t> compile(const std::string &sourcePath, const std::vector<std::string> &defines = {});
+    // every file the last compile of sourcePath with each set of defines read, the source itself included
+    std::vector<std::string> getDependencies(const std::string &sourcePath);
+    uint64_t getCompileCount();
+    uint64_t getCacheHits();
+
+private:
+    std::vector<uint32_t> readSpirv(const std::string &filePath);
+#ifdef LVE_SHADERC
+    void writeSpirv(const std::string &filePath, const std::vector<uint32_t> &code);
+#endif
+
+    std::string cacheDirectory;
+
+    std::mutex mutex;
+    // per source and set of defines
+    std::unordered_map<std::string, std::unordered_map<std::string, std::vector<std::string>>> dependencies;
+    std::atomic<uint64_t> tempFileCount = 0;
+    uint64_t compileCount = 0;
+    uint64_t cacheHits = 0;
+};
+} // namespace lve
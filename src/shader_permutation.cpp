@@ -0,0 +1,119 @@
+#include "shader_permutation.hpp"
+
+// std
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace lve {
+namespace {
+// in bit order, which is also the order of the defines
+constexpr std::array<std::pair<ShaderFeature, const char *>, 5> FEATURE_NAMES = {{
+    {SHADER_FEATURE_TEXTURED, "TEXTURED"},
+    {SHADER_FEATURE_ALPHA_BLEND, "ALPHA_BLEND"},
+    {SHADER_FEATURE_VERTEX_COLOR, "VERTEX_COLOR"},
+    {SHADER_FEATURE_INSTANCING, "INSTANCING"},
+    {SHADER_FEATURE_SKINNING, "SKINNING"},
+}};
+
+const std::string DECLARATION = "// features:";
+
+ShaderFeatures readDeclaredFeatures(const std::string &sourcePath) {
+    std::ifstream file{sourcePath};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + sourcePath);
+    }
+
+    ShaderFeatures features = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind(DECLARATION, 0) != 0) {
+            continue;
+        }
+        std::istringstream keywords{line.substr(DECLARATION.size())};
+        std::string keyword;
+        while (keywords >> keyword) {
+            auto feature = std::find_if(FEATURE_NAMES.begin(), FEATURE_NAMES.end(),
+                                        [&keyword](const auto &entry) { return keyword == entry.second; });
+            if (feature == FEATURE_NAMES.end()) {
+                throw std::runtime_error("failed to read shader features, unknown feature " + keyword + " in " + sourcePath);
+            }
+            features |= feature->first;
+        }
+    }
+    return features;
+}
+} // namespace
+
+ShaderPermutations::ShaderPermutations(const std::vector<std::string> &sourcePaths) {
+    for (const std::string &sourcePath : sourcePaths) {
+        ShaderFeatures features = readDeclaredFeatures(sourcePath);
+        stageFeatures[sourcePath] = features;
+        declaredFeatures |= features;
+    }
+}
+
+std::vector<std::string> ShaderPermutations::getDefines(const std::string &sourcePath, ShaderFeatures features) {
+    auto it = stageFeatures.find(sourcePath);
+    if (it == stageFeatures.end()) {
+        throw std::runtime_error("failed to find shader permutations of " + sourcePath);
+    }
+
+    // a feature the stage does not declare would only make another copy of the same code
+    std::vector<std::string> defines;
+    for (const auto &[feature, name] : FEATURE_NAMES) {
+        if ((features & it->second & feature) != 0) {
+            defines.push_back(name);
+        }
+    }
+    return defines;
+}
+
+std::vector<ShaderFeatures> ShaderPermutations::getVariants(const std::vector<ShaderFeatures> &requested) {
+    std::vector<ShaderFeatures> variants{declaredFeatures};
+    if ((declaredFeatures & SHADER_FEATURE_ALPHA_BLEND) != 0) {
+        variants.push_back(declaredFeatures & ~SHADER_FEATURE_ALPHA_BLEND);
+    }
+    for (ShaderFeatures features : requested) {
+        features &= declaredFeatures;
+        if (std::find(variants.begin(), variants.end(), features) == variants.end()) {
+            variants.push_back(features);
+        }
+    }
+
+    if (variants.size() > MAX_VARIANTS) {
+        throw std::runtime_error("failed to create shader permutations, " + std::to_string(variants.size()) +
+                                 " variants requested but at most " + std::to_string(MAX_VARIANTS) + " are compiled");
+    }
+    return variants;
+}
+
+std::string ShaderPermutations::getName(ShaderFeatures features) {
+    std::string name;
+    for (const auto &[feature, featureName] : FEATURE_NAMES) {
+        if ((features & feature) != 0) {
+            name += name.empty() ? featureName : std::string{"|"} + featureName;
+        }
+    }
+    return name.empty() ? "none" : name;
+}
+
+Pipeline &selectPipelineVariant(std::vector<Pipeline> &variants, ShaderFeatures required) {
+    Pipeline *selected = nullptr;
+    for (Pipeline &variant : variants) {
+        bool covers = (variant.features & required) == required;
+        bool sameBlend = ((variant.features ^ required) & SHADER_FEATURE_ALPHA_BLEND) == 0;
+        if (covers && sameBlend && (selected == nullptr || std::popcount(variant.features) < std::popcount(selected->features))) {
+            selected = &variant;
+        }
+    }
+    if (selected == nullptr) {
+        throw std::runtime_error("failed to select a shader variant with " + ShaderPermutations::getName(required));
+    }
+    return *selected;
+}
+} // namespace lve
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "lve_types.hpp"
+
+// std
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// The variants of the shaders of one pipeline, one per set of ShaderFeatures. A shader declares the
+// features it implements on a line of its own, like
+//
+//     // features: TEXTURED VERTEX_COLOR
+//
+// and checks them with #ifdef. Only requested variants are compiled, limited to what the shaders
+// declare, so the count stays far below every combination of the declared features.
+class ShaderPermutations {
+public:
+    static constexpr size_t MAX_VARIANTS = 8;
+
+    explicit ShaderPermutations(const std::vector<std::string> &sourcePaths);
+
+    ShaderFeatures getDeclaredFeatures() { return declaredFeatures; }
+    // the features of the variant a stage declares, as defines for the ShaderCompiler
+    std::vector<std::string> getDefines(const std::string &sourcePath, ShaderFeatures features);
+    // the variants with every declared feature, alpha blended first and opaque, that any material can
+    // fall back to, then the requested ones limited to the declared features. Throws when that is
+    // more than MAX_VARIANTS
+    std::vector<ShaderFeatures> getVariants(const std::vector<ShaderFeatures> &requested);
+
+    // like TEXTURED|ALPHA_BLEND
+    static std::string getName(ShaderFeatures features);
+
+private:
+    std::unordered_map<std::string, ShaderFeatures> stageFeatures;
+    ShaderFeatures declaredFeatures = 0;
+};
+
+// the variant with the fewest features that has every required one. Alpha blending changes the
+// render state, so it has to match exactly
+Pipeline &selectPipelineVariant(std::vector<Pipeline> &variants, ShaderFeatures required);
+} // namespace lve
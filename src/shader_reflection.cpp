@@ -0,0 +1,314 @@
+#include "shader_reflection.hpp"
+
+// std
+#include <algorithm>
+#include <unordered_map>
+
+namespace lve {
+namespace {
+// the subset of the SPIR-V spec that describes descriptors and push constants
+constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+constexpr uint32_t HEADER_WORDS = 5;
+
+enum Op : uint32_t {
+    OpEntryPoint = 15,
+    OpTypeInt = 21,
+    OpTypeFloat = 22,
+    OpTypeVector = 23,
+    OpTypeMatrix = 24,
+    OpTypeImage = 25,
+    OpTypeSampler = 26,
+    OpTypeSampledImage = 27,
+    OpTypeArray = 28,
+    OpTypeRuntimeArray = 29,
+    OpTypeStruct = 30,
+    OpTypePointer = 32,
+    OpConstant = 43,
+    OpSpecConstant = 50,
+    OpVariable = 59,
+    OpDecorate = 71,
+    OpMemberDecorate = 72,
+};
+
+enum Decoration : uint32_t {
+    DecorationBlock = 2,
+    DecorationBufferBlock = 3,
+    DecorationArrayStride = 6,
+    DecorationMatrixStride = 7,
+    DecorationBinding = 33,
+    DecorationDescriptorSet = 34,
+    DecorationOffset = 35,
+};
+
+enum StorageClass : uint32_t {
+    StorageClassUniformConstant = 0,
+    StorageClassUniform = 2,
+    StorageClassPushConstant = 9,
+    StorageClassStorageBuffer = 12,
+};
+
+constexpr uint32_t DIM_BUFFER = 5;
+constexpr uint32_t DIM_SUBPASS_DATA = 6;
+
+VkShaderStageFlagBits executionModelStage(uint32_t executionModel) {
+    switch (executionModel) {
+    case 0:
+        return VK_SHADER_STAGE_VERTEX_BIT;
+    case 1:
+        return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+    case 2:
+        return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+    case 3:
+        return VK_SHADER_STAGE_GEOMETRY_BIT;
+    case 4:
+        return VK_SHADER_STAGE_FRAGMENT_BIT;
+    case 5:
+        return VK_SHADER_STAGE_COMPUTE_BIT;
+    default:
+        throw std::runtime_error("failed to reflect shader, unsupported execution model");
+    }
+}
+
+// ids of one module, every instruction is kept as its operands after the opcode
+struct Module {
+    std::unordered_map<uint32_t, std::vector<uint32_t>> types;
+    std::unordered_map<uint32_t, uint32_t> constants;
+    std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>> decorations;
+    // keyed by struct id, then member index
+    std::unordered_map<uint32_t, std::unordered_map<uint32_t, std::unordered_map<uint32_t, uint32_t>>> memberDecorations;
+    std::vector<std::vector<uint32_t>> variables;
+
+    bool hasDecoration(uint32_t id, uint32_t decoration) const {
+        auto it = decorations.find(id);
+        return it != decorations.end() && it->second.contains(decoration);
+    }
+
+    uint32_t getDecoration(uint32_t id, uint32_t decoration) const {
+        auto it = decorations.find(id);
+        if (it == decorations.end() || !it->second.contains(decoration)) {
+            return 0;
+        }
+        return it->second.at(decoration);
+    }
+
+    uint32_t getMemberDecoration(uint32_t structId, uint32_t member, uint32_t decoration) const {
+        auto structIt = memberDecorations.find(structId);
+        if (structIt == memberDecorations.end()) {
+            return 0;
+        }
+        auto memberIt = structIt->second.find(member);
+        if (memberIt == structIt->second.end() || !memberIt->second.contains(decoration)) {
+            return 0;
+        }
+        return memberIt->second.at(decoration);
+    }
+
+    const std::vector<uint32_t> &getType(uint32_t id) const {
+        auto it = types.find(id);
+        if (it == types.end()) {
+            throw std::runtime_error("failed to reflect shader, unknown type id");
+        }
+        return it->second;
+    }
+
+    // bytes the type takes in a block, matrixStride comes from the member that holds it
+    uint32_t getSize(uint32_t id, uint32_t matrixStride = 0) const {
+        const std::vector<uint32_t> &type = getType(id);
+        switch (type[0]) {
+        case OpTypeInt:
+        case OpTypeFloat:
+            return type[2] / 8;
+        case OpTypeVector:
+            return type[3] * getSize(type[2]);
+        case OpTypeMatrix:
+            return type[3] * (matrixStride != 0 ? matrixStride : getSize(type[2]));
+        case OpTypeArray: {
+            uint32_t stride = getDecoration(id, DecorationArrayStride);
+            return constants.at(type[3]) * (stride != 0 ? stride : getSize(type[2]));
+        }
+        case OpTypeStruct: {
+            uint32_t size = 0;
+            for (uint32_t member = 0; member + 2 < type.size(); member++) {
+                uint32_t offset = getMemberDecoration(id, member, DecorationOffset);
+                uint32_t memberStride = getMemberDecoration(id, member, DecorationMatrixStride);
+                size = std::max(size, offset + getSize(type[member + 2], memberStride));
+            }
+            return size;
+        }
+        default:
+            // runtime arrays have no size of their own
+            return 0;
+        }
+    }
+};
+} // namespace
+
+ShaderReflection::ShaderReflection(const std::vector<uint32_t> &code) {
+    if (code.size() < HEADER_WORDS || code[0] != SPIRV_MAGIC) {
+        throw std::runtime_error("failed to reflect shader, not SPIR-V");
+    }
+
+    Module module;
+    for (size_t i = HEADER_WORDS; i < code.size();) {
+        uint32_t wordCount = code[i] >> 16;
+        uint32_t opcode = code[i] & 0xffff;
+        if (wordCount == 0 || i + wordCount > code.size()) {
+            throw std::runtime_error("failed to reflect shader, truncated instruction");
+        }
+        const uint32_t *operands = &code[i + 1];
+        uint32_t operandCount = wordCount - 1;
+
+        switch (opcode) {
+        case OpEntryPoint:
+            stages |= executionModelStage(operands[0]);
+            break;
+        case OpTypeInt:
+        case OpTypeFloat:
+        case OpTypeVector:
+        case OpTypeMatrix:
+        case OpTypeImage:
+        case OpTypeSampler:
+        case OpTypeSampledImage:
+        case OpTypeArray:
+        case OpTypeRuntimeArray:
+        case OpTypeStruct:
+        case OpTypePointer: {
+            std::vector<uint32_t> type{opcode};
+            type.insert(type.end(), operands, operands + operandCount);
+            module.types[operands[0]] = std::move(type);
+            break;
+        }
+        case OpConstant:
+        case OpSpecConstant:
+            // array lengths are 32 bit, wider constants are never one
+            module.constants[operands[1]] = operands[2];
+            break;
+        case OpVariable:
+            module.variables.push_back({operands, operands + operandCount});
+            break;
+        case OpDecorate:
+            module.decorations[operands[0]][operands[1]] = operandCount > 2 ? operands[2] : 0;
+            break;
+        case OpMemberDecorate:
+            module.memberDecorations[operands[0]][operands[1]][operands[2]] = operandCount > 3 ? operands[3] : 0;
+            break;
+        default:
+            break;
+        }
+        i += wordCount;
+    }
+
+    for (const std::vector<uint32_t> &variable : module.variables) {
+        uint32_t id = variable[1];
+        uint32_t storageClass = variable[2];
+        // variables are pointers, the descriptor is what they point to
+        uint32_t typeId = module.getType(variable[0])[3];
+
+        if (storageClass == StorageClassPushConstant) {
+            pushConstantRange.stageFlags = stages;
+            pushConstantRange.offset = 0;
+            pushConstantRange.size = module.getSize(typeId);
+            continue;
+        }
+        if (storageClass != StorageClassUniformConstant && storageClass != StorageClassUniform &&
+            storageClass != StorageClassStorageBuffer) {
+            continue;
+        }
+
+        VkDescriptorSetLayoutBinding binding{};
+        binding.binding = module.getDecoration(id, DecorationBinding);
+        binding.stageFlags = stages;
+        binding.descriptorCount = 1;
+        const std::vector<uint32_t> *type = &module.getType(typeId);
+        if ((*type)[0] == OpTypeArray) {
+            binding.descriptorCount = module.constants.at((*type)[3]);
+            typeId = (*type)[2];
+            type = &module.getType(typeId);
+        } else if ((*type)[0] == OpTypeRuntimeArray) {
+            binding.descriptorCount = 0;
+            typeId = (*type)[2];
+            type = &module.getType(typeId);
+        }
+
+        switch ((*type)[0]) {
+        case OpTypeSampler:
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_SAMPLER;
+            break;
+        case OpTypeSampledImage:
+            binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            break;
+        case OpTypeImage: {
+            uint32_t dim = (*type)[3];
+            bool storage = (*type)[7] == 2;
+            if (dim == DIM_SUBPASS_DATA) {
+                binding.descriptorType = VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+            } else if (dim == DIM_BUFFER) {
+                binding.descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER;
+            } else {
+                binding.descriptorType = storage ? VK_DESCRIPTOR_TYPE_STORAGE_IMAGE : VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE;
+            }
+            break;
+        }
+        case OpTypeStruct:
+            // before SPIR-V 1.3 storage buffers are Uniform blocks decorated BufferBlock
+            if (storageClass == StorageClassStorageBuffer || module.hasDecoration(typeId, DecorationBufferBlock)) {
+                binding.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            } else {
+                binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+            }
+            break;
+        default:
+            throw std::runtime_error("failed to reflect shader, unsupported descriptor type");
+        }
+
+        bindings[{module.getDecoration(id, DecorationDescriptorSet), binding.binding}] = binding;
+    }
+}
+
+void ShaderReflection::merge(const ShaderReflection &other) {
+    stages |= other.stages;
+    for (const auto &[key, binding] : other.bindings) {
+        auto [it, inserted] = bindings.emplace(key, binding);
+        if (inserted) {
+            continue;
+        }
+        if (it->second.descriptorType != binding.descriptorType || it->second.descriptorCount != binding.descriptorCount) {
+            throw std::runtime_error("failed to merge shader reflection, stages disagree on set " + std::to_string(key.first) +
+                                     " binding " + std::to_string(key.second));
+        }
+        it->second.stageFlags |= binding.stageFlags;
+    }
+
+    if (other.pushConstantRange.stageFlags != 0) {
+        pushConstantRange.stageFlags |= other.pushConstantRange.stageFlags;
+        pushConstantRange.size = std::max(pushConstantRange.size, other.pushConstantRange.size);
+    }
+}
+
+void ShaderReflection::setImmutableSamplers(uint32_t set, uint32_t binding, const VkSampler *samplers) {
+    getBinding(set, binding).pImmutableSamplers = samplers;
+}
+
+void ShaderReflection::setDescriptorCount(uint32_t set, uint32_t binding, uint32_t count) {
+    getBinding(set, binding).descriptorCount = count;
+}
+
+std::vector<VkDescriptorSetLayoutBinding> ShaderReflection::getBindings(uint32_t set) const {
+    std::vector<VkDescriptorSetLayoutBinding> setBindings;
+    for (const auto &[key, binding] : bindings) {
+        if (key.first == set) {
+            setBindings.push_back(binding);
+        }
+    }
+    return setBindings;
+}
+
+VkDescriptorSetLayoutBinding &ShaderReflection::getBinding(uint32_t set, uint32_t binding) {
+    auto it = bindings.find({set, binding});
+    if (it == bindings.end()) {
+        throw std::runtime_error("failed to find binding " + std::to_string(binding) + " of set " + std::to_string(set) +
+                                 " in the shaders");
+    }
+    return it->second;
+}
+} // namespace lve
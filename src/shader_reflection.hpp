@@ -0,0 +1,49 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+// std
+#include <cstdint>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace lve {
+// Descriptor bindings and push constants read from SPIR-V, so pipeline layouts follow the shaders
+// instead of being written out by hand next to them. Reflections of the stages of a pipeline are
+// merged into one. What SPIR-V does not say, immutable samplers and the size of runtime arrays, is
+// filled in before the bindings are passed to the DescriptorLayoutCache.
+class ShaderReflection {
+public:
+    explicit ShaderReflection(const std::vector<uint32_t> &code);
+
+    // a binding used by both must agree on type and count, its stages are combined
+    void merge(const ShaderReflection &other);
+
+    void setImmutableSamplers(uint32_t set, uint32_t binding, const VkSampler *samplers);
+    // runtime arrays, like textures[], reflect a descriptorCount of 0
+    void setDescriptorCount(uint32_t set, uint32_t binding, uint32_t count);
+
+    VkShaderStageFlags getStages() const { return stages; }
+    // ordered by binding
+    std::vector<VkDescriptorSetLayoutBinding> getBindings(uint32_t set) const;
+    // one range for every stage that declares the block, throws when T is not the reflected size
+    template <typename T> VkPushConstantRange getPushConstantRange(const std::string &name) const {
+        if (pushConstantRange.size != sizeof(T)) {
+            throw std::runtime_error("failed to match push constants, " + name + " is " + std::to_string(sizeof(T)) +
+                                     " bytes but the shaders declare " + std::to_string(pushConstantRange.size));
+        }
+        return pushConstantRange;
+    }
+
+private:
+    VkDescriptorSetLayoutBinding &getBinding(uint32_t set, uint32_t binding);
+
+    VkShaderStageFlags stages = 0;
+    // keyed by set and binding
+    std::map<std::pair<uint32_t, uint32_t>, VkDescriptorSetLayoutBinding> bindings;
+    VkPushConstantRange pushConstantRange{};
+};
+} // namespace lve
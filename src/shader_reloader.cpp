@@ -0,0 +1,170 @@
+#include "shader_reloader.hpp"
+#include "initializers/pipelines.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <system_error>
+
+namespace lve {
+ShaderReloader::ShaderReloader(LveDevice &device, LveSwapChain &swapChain, ApplicationPipelines &pipelines,
+                               PipelineCompiler &pipelineCompiler, util::ThreadPool &threadPool)
+    : device{device}, swapChain{swapChain}, pipelines{pipelines}, pipelineCompiler{pipelineCompiler}, threadPool{threadPool} {}
+
+ShaderReloader::~ShaderReloader() {
+    for (Rebuild &rebuild : rebuilds) {
+        try {
+            rebuild.future.get();
+            std::vector<Pipeline> staged;
+            for (Pipeline *pipeline : getGroupPipelines(rebuild.group, *rebuild.pipelines)) {
+                staged.push_back(*pipeline);
+            }
+            destroyPipelines(staged);
+        } catch (const std::exception &) {
+            // nothing was handed out for a failed rebuild
+        }
+    }
+    for (const RetiredGroup &retired : retiredGroups) {
+        destroyPipelines(retired.pipelines);
+    }
+}
+
+bool ShaderReloader::update() {
+    frame++;
+
+    // a frame waits on the frame timeline for the frame framesInFlight before it, so by now every
+    // frame recorded before the group was replaced has finished
+    while (!retiredGroups.empty() && frame - retiredGroups.front().frame >= device.getFramesInFlight()) {
+        destroyPipelines(retiredGroups.front().pipelines);
+        retiredGroups.pop_front();
+    }
+
+    bool replaced = false;
+    for (auto it = rebuilds.begin(); it != rebuilds.end();) {
+        if (it->future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            it++;
+            continue;
+        }
+        replaced |= finishRebuild(*it);
+        it = rebuilds.erase(it);
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastPoll >= POLL_INTERVAL) {
+        lastPoll = now;
+        pollShaders();
+    }
+    return replaced;
+}
+
+std::vector<Pipeline *> ShaderReloader::getGroupPipelines(PipelineGroup group, ApplicationPipelines &pipelines) {
+    // the first pipeline of a group owns the layout and shader modules the others share
+    switch (group) {
+    case PipelineGroup::Graphics: {
+        std::vector<Pipeline *> variants;
+        for (Pipeline &variant : pipelines.graphicsVariants) {
+            variants.push_back(&variant);
+        }
+        return variants;
+    }
+    case PipelineGroup::Bindless:
+        return {&pipelines.bindlessOpaquePipeline, &pipelines.bindlessTransparentPipeline};
+    case PipelineGroup::Compute:
+        return {&pipelines.computePipelines.perlinNoisePipeline};
+    }
+    return {};
+}
+
+std::filesystem::file_time_type ShaderReloader::getLastWriteTime(PipelineGroup group) {
+    std::filesystem::file_time_type lastWriteTime{};
+    for (const std::string &source : getGroupPipelines(group, pipelines)[0]->shaderSources) {
+        for (const std::string &file : device.shaderCompiler().getDependencies(source)) {
+            // editors may replace the file while saving, it is picked up on the next poll
+            std::error_code error;
+            std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(file, error);
+            if (!error) {
+                lastWriteTime = std::max(lastWriteTime, writeTime);
+            }
+        }
+    }
+    return lastWriteTime;
+}
+
+void ShaderReloader::pollShaders() {
+    for (PipelineGroup group : {PipelineGroup::Graphics, PipelineGroup::Bindless, PipelineGroup::Compute}) {
+        // groups still compiling at startup, or never submitted, are not watched yet
+        if (!pipelineCompiler.isReady(group)) {
+            continue;
+        }
+        bool rebuilding =
+            std::any_of(rebuilds.begin(), rebuilds.end(), [group](const Rebuild &rebuild) { return rebuild.group == group; });
+        if (rebuilding) {
+            continue;
+        }
+
+        std::filesystem::file_time_type lastWriteTime = getLastWriteTime(group);
+        auto [it, first] = writeTimes.try_emplace(group, lastWriteTime);
+        if (first || lastWriteTime <= it->second) {
+            continue;
+        }
+        it->second = lastWriteTime;
+
+        // built into a copy, the current pipelines stay in use until the copy is complete
+        Rebuild rebuild{group, std::make_unique<ApplicationPipelines>()};
+        ApplicationPipelines *staged = rebuild.pipelines.get();
+        rebuild.future = threadPool.submit([this, group, staged] { init::createPipelineGroup(group, &device, &swapChain, staged); });
+        rebuilds.push_back(std::move(rebuild));
+    }
+}
+
+bool ShaderReloader::finishRebuild(Rebuild &rebuild) {
+    try {
+        rebuild.future.get();
+    } catch (const std::exception &e) {
+        std::cerr << "shader reload failed, keeping the old pipelines: " << e.what() << std::endl;
+        return false;
+    }
+
+    std::vector<Pipeline *> current = getGroupPipelines(rebuild.group, pipelines);
+    std::vector<Pipeline *> staged = getGroupPipelines(rebuild.group, *rebuild.pipelines);
+    // models hold on to the variants they selected, which are only replaced one for one
+    bool sameVariants = current.size() == staged.size() &&
+                        std::equal(current.begin(), current.end(), staged.begin(),
+                                   [](const Pipeline *a, const Pipeline *b) { return a->features == b->features; });
+    if (!sameVariants) {
+        std::cerr << "shader reload failed, the declared shader features changed, restart to pick them up" << std::endl;
+        std::vector<Pipeline> stagedPipelines;
+        for (Pipeline *pipeline : staged) {
+            stagedPipelines.push_back(*pipeline);
+        }
+        destroyPipelines(stagedPipelines);
+        return false;
+    }
+
+    // models reference the members of ApplicationPipelines, so they draw with the new pipelines from here on
+    RetiredGroup retired{frame, {}};
+    for (size_t i = 0; i < current.size(); i++) {
+        retired.pipelines.push_back(*current[i]);
+        *current[i] = *staged[i];
+    }
+    if (rebuild.group == PipelineGroup::Compute) {
+        pipelines.computePipelines.perlinNoiseSpecialization = rebuild.pipelines->computePipelines.perlinNoiseSpecialization;
+    }
+    retiredGroups.push_back(std::move(retired));
+    reloadCount++;
+    return true;
+}
+
+void ShaderReloader::destroyPipelines(const std::vector<Pipeline> &groupPipelines) {
+    // with extended dynamic state the pipelines of a group can share one id
+    std::vector<PipelineId> ids;
+    for (const Pipeline &pipeline : groupPipelines) {
+        if (std::find(ids.begin(), ids.end(), pipeline.id) == ids.end()) {
+            ids.push_back(pipeline.id);
+            device.pipelineRegistry().releasePipeline(pipeline.id);
+        }
+    }
+    destroyPipeline(device, groupPipelines[0]);
+}
+} // namespace lve
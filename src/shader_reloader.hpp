@@ -0,0 +1,77 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_types.hpp"
+#include "pipeline_compiler.hpp"
+#include "utility/thread_pool.hpp"
+
+// std
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Watches the shaders each pipeline group was compiled from, and their includes, and rebuilds the
+// group on the thread pool when one of them changes. The rebuilt pipelines replace the old ones in
+// ApplicationPipelines between frames, so the frame loop never stops, and the old ones are destroyed
+// once the frames recorded with them are out of flight. A shader that fails to compile leaves the
+// old pipelines in place.
+class ShaderReloader {
+public:
+    static constexpr std::chrono::milliseconds POLL_INTERVAL{500};
+
+    ShaderReloader(LveDevice &device, LveSwapChain &swapChain, ApplicationPipelines &pipelines, PipelineCompiler &pipelineCompiler,
+                   util::ThreadPool &threadPool);
+    // the device has to be idle, retired pipelines are destroyed right away
+    ~ShaderReloader();
+
+    // Not copyable or movable
+    ShaderReloader(const ShaderReloader &) = delete;
+    ShaderReloader &operator=(const ShaderReloader &) = delete;
+    ShaderReloader(ShaderReloader &&) = delete;
+    ShaderReloader &operator=(ShaderReloader &&) = delete;
+
+    // once per frame before recording, true when pipelines were replaced
+    bool update();
+    uint64_t getReloadCount() { return reloadCount; }
+
+private:
+    struct Rebuild {
+        PipelineGroup group;
+        std::unique_ptr<ApplicationPipelines> pipelines;
+        std::future<void> future;
+    };
+
+    struct RetiredGroup {
+        // update call the group was replaced in
+        uint64_t frame;
+        std::vector<Pipeline> pipelines;
+    };
+
+    static std::vector<Pipeline *> getGroupPipelines(PipelineGroup group, ApplicationPipelines &pipelines);
+    std::filesystem::file_time_type getLastWriteTime(PipelineGroup group);
+    void pollShaders();
+    // true when the group was replaced
+    bool finishRebuild(Rebuild &rebuild);
+    void destroyPipelines(const std::vector<Pipeline> &pipelines);
+
+    LveDevice &device;
+    LveSwapChain &swapChain;
+    ApplicationPipelines &pipelines;
+    PipelineCompiler &pipelineCompiler;
+    util::ThreadPool &threadPool;
+
+    uint64_t frame = 0;
+    uint64_t reloadCount = 0;
+    std::chrono::steady_clock::time_point lastPoll{};
+    std::unordered_map<PipelineGroup, std::filesystem::file_time_type> writeTimes;
+    std::vector<Rebuild> rebuilds;
+    std::deque<RetiredGroup> retiredGroups;
+};
+} // namespace lve
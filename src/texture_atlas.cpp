@@ -0,0 +1,182 @@
+#include "texture_atlas.hpp"
+#include "initializers/images.hpp"
+#include "utility/images.hpp"
+
+#include <stb_image.h>
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imstb_rectpack.h"
+
+// std
+#include <algorithm>
+#include <cstring>
+#include <future>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace lve {
+namespace {
+// rectangles are packed in units of PADDING texels, so every entry starts on a texel of each
+// mip level up to MIP_LEVELS - 1
+uint32_t gridCells(uint32_t size) {
+    return (size + 2 * TextureAtlas::PADDING + TextureAtlas::PADDING - 1) / TextureAtlas::PADDING;
+}
+} // namespace
+
+TextureAtlas::TextureAtlas(LveDevice &device, util::ThreadPool &threadPool, const std::vector<std::string> &paths)
+    : device{device} {
+    std::unordered_set<std::string> seenPaths;
+    std::vector<std::future<Entry>> decodes;
+    for (const std::string &path : paths) {
+        int texWidth, texHeight, texChannels;
+        if (!stbi_info(path.c_str(), &texWidth, &texHeight, &texChannels)) {
+            throw std::runtime_error("failed to load texture image: " + path);
+        }
+        if (std::max(texWidth, texHeight) > static_cast<int>(MAX_ENTRY_SIZE) || !seenPaths.insert(path).second) {
+            continue;
+        }
+
+        decodes.push_back(threadPool.submit([path] {
+            int texWidth, texHeight, texChannels;
+            stbi_uc *pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            if (!pixels) {
+                throw std::runtime_error("failed to load texture image: " + path);
+            }
+            return Entry{path, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight),
+                         std::shared_ptr<uint8_t>(pixels, stbi_image_free)};
+        }));
+    }
+
+    std::vector<Entry> entries;
+    for (auto &decode : decodes) {
+        entries.push_back(decode.get());
+    }
+
+    const int pageCells = static_cast<int>(MAX_PAGE_SIZE / PADDING);
+    std::vector<stbrp_rect> remaining;
+    for (size_t i = 0; i < entries.size(); i++) {
+        stbrp_rect rect{};
+        rect.id = static_cast<int>(i);
+        rect.w = static_cast<int>(gridCells(entries[i].width));
+        rect.h = static_cast<int>(gridCells(entries[i].height));
+        remaining.push_back(rect);
+    }
+
+    // fill a page, then start the next one with whatever did not fit
+    while (!remaining.empty()) {
+        stbrp_context context;
+        std::vector<stbrp_node> nodes(pageCells);
+        stbrp_init_target(&context, pageCells, pageCells, nodes.data(), static_cast<int>(nodes.size()));
+        stbrp_pack_rects(&context, remaining.data(), static_cast<int>(remaining.size()));
+
+        std::vector<Placement> placements;
+        std::vector<stbrp_rect> unpacked;
+        for (const stbrp_rect &rect : remaining) {
+            if (rect.was_packed) {
+                uint32_t x = static_cast<uint32_t>(rect.x) * PADDING;
+                uint32_t y = static_cast<uint32_t>(rect.y) * PADDING;
+                placements.push_back({&entries[rect.id], x, y});
+            } else {
+                unpacked.push_back(rect);
+            }
+        }
+        if (placements.empty()) {
+            throw std::runtime_error("failed to pack texture atlas page");
+        }
+
+        createPage(placements);
+        remaining = std::move(unpacked);
+    }
+}
+
+void TextureAtlas::createPage(const std::vector<Placement> &placements) {
+    // trim the page to what was packed, both edges stay multiples of PADDING
+    uint32_t width = 0;
+    uint32_t height = 0;
+    for (const Placement &placement : placements) {
+        width = std::max(width, placement.x + gridCells(placement.entry->width) * PADDING);
+        height = std::max(height, placement.y + gridCells(placement.entry->height) * PADDING);
+    }
+
+    const VkFormat format = VK_FORMAT_R8G8B8A8_SRGB;
+    uint32_t mipLevels = MIP_LEVELS;
+    // the mips are blitted down with linear filtering
+    VkFormatFeatureFlags mipFeatures =
+        VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT;
+    if (!device.isFormatSupported(format, VK_IMAGE_TILING_OPTIMAL, mipFeatures)) {
+        mipLevels = 1;
+    }
+
+    VkDeviceSize bufferSize = static_cast<VkDeviceSize>(width) * height * 4;
+    VkBuffer stagingBuffer;
+    VkDeviceMemory stagingBufferMemory;
+    device.createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
+                        stagingBufferMemory);
+
+    uint8_t *data;
+    vkMapMemory(device.device(), stagingBufferMemory, 0, bufferSize, 0, reinterpret_cast<void **>(&data));
+    memset(data, 0, bufferSize);
+    for (const Placement &placement : placements) {
+        const Entry &entry = *placement.entry;
+        uint32_t cellWidth = gridCells(entry.width) * PADDING;
+        uint32_t cellHeight = gridCells(entry.height) * PADDING;
+        const uint8_t *pixels = entry.pixels.get();
+
+        // the gutter repeats the nearest edge texel, like clamp to edge addressing
+        for (uint32_t y = 0; y < cellHeight; y++) {
+            int32_t sourceY =
+                std::clamp(static_cast<int32_t>(y) - static_cast<int32_t>(PADDING), 0, static_cast<int32_t>(entry.height) - 1);
+            const uint8_t *sourceRow = pixels + static_cast<size_t>(sourceY) * entry.width * 4;
+            uint8_t *row = data + (static_cast<size_t>(placement.y + y) * width + placement.x) * 4;
+            for (uint32_t x = 0; x < cellWidth; x++) {
+                int32_t sourceX =
+                    std::clamp(static_cast<int32_t>(x) - static_cast<int32_t>(PADDING), 0, static_cast<int32_t>(entry.width) - 1);
+                memcpy(row + x * 4, sourceRow + sourceX * 4, 4);
+            }
+        }
+    }
+    vkUnmapMemory(device.device(), stagingBufferMemory);
+
+    AllocatedImage image;
+    init::createImage(&device, width, height, format, VK_IMAGE_TILING_OPTIMAL,
+                      VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, mipLevels);
+
+    VkBufferImageCopy region{};
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageExtent = {width, height, 1};
+
+    VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+    util::transitionImageLayout(commandBuffer, image.image, format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                mipLevels);
+    vkCmdCopyBufferToImage(commandBuffer, stagingBuffer, image.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    util::generateMipmaps(commandBuffer, image.image, width, height, mipLevels);
+    device.endSingleTimeCommands(commandBuffer);
+
+    vkDestroyBuffer(device.device(), stagingBuffer, nullptr);
+    vkFreeMemory(device.device(), stagingBufferMemory, nullptr);
+
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device.device(), image.image, &memRequirements);
+    size += memRequirements.size;
+
+    VkDevice vkDevice = device.device();
+    auto page = std::shared_ptr<AllocatedImage>(new AllocatedImage{image}, [vkDevice](AllocatedImage *image) {
+        destroyImage(vkDevice, *image);
+        delete image;
+    });
+    pages.push_back(page);
+
+    for (const Placement &placement : placements) {
+        const Entry &entry = *placement.entry;
+        glm::vec4 uvTransform{static_cast<float>(entry.width) / width, static_cast<float>(entry.height) / height,
+                              static_cast<float>(placement.x + PADDING) / width, static_cast<float>(placement.y + PADDING) / height};
+        regions[entry.path] = {page, uvTransform};
+    }
+}
+} // namespace lve
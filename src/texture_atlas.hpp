@@ -0,0 +1,76 @@
+#pragma once
+
+#include "lve_device.hpp"
+#include "lve_types.hpp"
+#include "utility/thread_pool.hpp"
+
+#include <glm/glm.hpp>
+
+// std
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lve {
+// Packs small textures into shared pages, so each page costs one image, view and descriptor
+// instead of one per texture. Entries sit on a PADDING texel grid inside a gutter of their own
+// replicated edge texels, which keeps linear filtering and the first MIP_LEVELS mips from
+// reading a neighbour. Meshes keep their texture coordinates and the region's uvTransform maps
+// them into the page, which only holds for coordinates within [0, 1] as wrapping leaves the entry.
+// Scenes get atlases through AssetCache::acquireAtlas rather than building their own.
+class TextureAtlas {
+public:
+    static constexpr uint32_t MAX_PAGE_SIZE = 2048;
+    // textures with a larger edge keep an image of their own
+    static constexpr uint32_t MAX_ENTRY_SIZE = 256;
+    static constexpr uint32_t MIP_LEVELS = 4;
+    static constexpr uint32_t PADDING = 1u << (MIP_LEVELS - 1);
+
+    struct Region {
+        std::shared_ptr<AllocatedImage> page;
+        // xy scales and zw offsets texture coordinates into the page
+        glm::vec4 uvTransform;
+    };
+
+    // paths with an edge over MAX_ENTRY_SIZE are skipped, check contains() before getRegion()
+    TextureAtlas(LveDevice &device, util::ThreadPool &threadPool, const std::vector<std::string> &paths);
+
+    // Not copyable or movable
+    TextureAtlas(const TextureAtlas &) = delete;
+    TextureAtlas &operator=(const TextureAtlas &) = delete;
+    TextureAtlas(TextureAtlas &&) = delete;
+    TextureAtlas &operator=(TextureAtlas &&) = delete;
+
+    bool contains(const std::string &path) { return regions.find(path) != regions.end(); }
+    const Region &getRegion(const std::string &path) { return regions.at(path); }
+    size_t getEntryCount() { return regions.size(); }
+    size_t getPageCount() { return pages.size(); }
+    // device memory of every page
+    VkDeviceSize getSize() { return size; }
+
+private:
+    struct Entry {
+        std::string path;
+        uint32_t width;
+        uint32_t height;
+        std::shared_ptr<uint8_t> pixels;
+    };
+
+    struct Placement {
+        const Entry *entry;
+        // top left corner of the gutter, in texels
+        uint32_t x;
+        uint32_t y;
+    };
+
+    void createPage(const std::vector<Placement> &placements);
+
+    LveDevice &device;
+    // pages outlive the atlas while models still reference them
+    std::vector<std::shared_ptr<AllocatedImage>> pages;
+    std::unordered_map<std::string, Region> regions;
+    VkDeviceSize size = 0;
+};
+} // namespace lve
@@ -0,0 +1,237 @@
+#include "texture_streamer.hpp"
+#include "imgui.h"
+#include "initializers/initializers.hpp"
+
+// std
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+
+namespace lve {
+TextureStreamer::TextureStreamer(LveDevice &device, util::ThreadPool &threadPool, AssetCache &assetCache,
+                                 BindlessSet &bindlessSet)
+    : device{device}, threadPool{threadPool}, assetCache{assetCache}, bindlessSet{bindlessSet} {
+    VkCommandPoolCreateInfo poolInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO};
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+    poolInfo.queueFamilyIndex = device.findPhysicalQueueFamilies().graphicsFamily;
+    if (vkCreateCommandPool(device.device(), &poolInfo, nullptr, &uploadPool) != VK_SUCCESS) {
+        throw std::runtime_error("failed to create texture upload command pool");
+    }
+}
+
+TextureStreamer::~TextureStreamer() {
+    // the owning scene waits for the device to go idle before destroying the streamer
+    for (auto &texture : textures) {
+        if (texture->pending.valid()) {
+            try {
+                util::StagedTexture staged = texture->pending.get();
+                util::destroyStagedTexture(&device, staged);
+            } catch (const std::exception &) {
+            }
+        }
+        if (texture->uploading) {
+            util::destroyStagedTexture(&device, texture->uploadStaged);
+            destroyImage(device.device(), texture->uploadImage);
+        }
+        vkDestroyFence(device.device(), texture->uploadFence, nullptr);
+        if (texture->image.image != texture->tail->image) {
+            destroyImage(device.device(), texture->image);
+        }
+    }
+    // destroying the pool frees the upload command buffers
+    vkDestroyCommandPool(device.device(), uploadPool, nullptr);
+    for (RetiredImage &retired : retiredImages) {
+        destroyImage(device.device(), retired.image);
+    }
+}
+
+uint32_t TextureStreamer::addTexture(const std::string &path) {
+    auto texture = std::make_unique<StreamedTexture>();
+    texture->info = util::readTextureInfo(&device, path);
+    texture->levelCount = static_cast<uint32_t>(texture->info.levels.size());
+    texture->tailLevel = 0;
+    while (texture->tailLevel + 1 < texture->levelCount &&
+           std::max(texture->info.width, texture->info.height) >> texture->tailLevel > MIN_RESIDENT_SIZE) {
+        texture->tailLevel++;
+    }
+
+    texture->tail = assetCache.acquireTextureLevels(path, texture->tailLevel);
+    texture->image = *texture->tail;
+    texture->residentLevel = texture->tailLevel;
+    texture->residentBytes = imageSize(texture->image);
+    texture->requestedLevel = texture->tailLevel;
+    texture->lastRequested.assign(texture->levelCount, 0);
+    texture->recordedLevel.assign(device.getFramesInFlight(), texture->tailLevel);
+    texture->bindlessIndex = bindlessSet.registerTexture(texture->image);
+
+    uint32_t index = texture->bindlessIndex;
+    textures.push_back(std::move(texture));
+    return index;
+}
+
+void TextureStreamer::update(uint32_t currentFrame) {
+    frameNumber++;
+
+    const uint32_t *feedback = bindlessSet.getFeedback(currentFrame);
+    for (auto &texture : textures) {
+        uint32_t requested = feedback[texture->bindlessIndex];
+        if (requested != BindlessSet::NO_FEEDBACK) {
+            int32_t level = static_cast<int32_t>(texture->recordedLevel[currentFrame]) + static_cast<int32_t>(requested) -
+                            BindlessSet::FEEDBACK_LOD_BIAS;
+            texture->requestedLevel = static_cast<uint32_t>(std::clamp(level, 0, static_cast<int32_t>(texture->levelCount) - 1));
+            texture->lastRequested[texture->requestedLevel] = frameNumber;
+        }
+
+        // an upload submitted in an earlier frame swaps in once the GPU is done with it
+        if (texture->uploading && vkGetFenceStatus(device.device(), texture->uploadFence) == VK_SUCCESS) {
+            finishUpload(*texture);
+        }
+        if (texture->pending.valid() && texture->pending.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            submitUpload(*texture);
+        }
+        if (!texture->pending.valid() && !texture->uploading) {
+            uint32_t level = desiredLevel(*texture);
+            if (level == texture->tailLevel && texture->residentLevel != level) {
+                dropToTail(*texture);
+            } else if (level != texture->residentLevel) {
+                startStreaming(*texture, level);
+            }
+        }
+
+        // the set for this frame is bound next and picks up any swapped image
+        texture->recordedLevel[currentFrame] = texture->residentLevel;
+    }
+    bindlessSet.resetFeedback(currentFrame);
+
+    // frames recorded before a swap may still sample the old image until they finish
+    std::erase_if(retiredImages, [this](const RetiredImage &retired) {
+        if (frameNumber - retired.frame < device.getFramesInFlight()) {
+            return false;
+        }
+        destroyImage(device.device(), retired.image);
+        return true;
+    });
+}
+
+void TextureStreamer::showGui() {
+    ImGui::Begin("Texture Streaming");
+    ImGui::SliderInt("Evict after frames", &evictAfterFrames, 1, 2000);
+    for (size_t i = 0; i < textures.size(); i++) {
+        StreamedTexture &texture = *textures[i];
+        uint32_t residentLevels = texture.levelCount - texture.residentLevel;
+
+        ImGui::PushID(static_cast<int>(i));
+        ImGui::Separator();
+        ImGui::Text("%s", texture.info.path.c_str());
+        char overlay[64];
+        snprintf(overlay, sizeof(overlay), "mips %u-%u of %u", texture.residentLevel, texture.levelCount - 1, texture.levelCount);
+        ImGui::ProgressBar(static_cast<float>(residentLevels) / texture.levelCount, ImVec2(-1.0f, 0.0f), overlay);
+        ImGui::Text("resident %ux%u, %.2f MB", std::max(1u, texture.info.width >> texture.residentLevel),
+                    std::max(1u, texture.info.height >> texture.residentLevel), texture.residentBytes / (1024.0 * 1024.0));
+        ImGui::Text("requested mip %u, tail mip %u%s", texture.requestedLevel, texture.tailLevel,
+                    texture.pending.valid() || texture.uploading ? ", streaming" : "");
+        ImGui::PopID();
+    }
+    ImGui::End();
+}
+
+uint32_t TextureStreamer::desiredLevel(const StreamedTexture &texture) {
+    // finest level requested within the eviction window, the tail is always kept
+    for (uint32_t level = 0; level < texture.tailLevel; level++) {
+        uint64_t lastRequested = texture.lastRequested[level];
+        if (lastRequested != 0 && frameNumber - lastRequested < static_cast<uint64_t>(evictAfterFrames)) {
+            return level;
+        }
+    }
+    return texture.tailLevel;
+}
+
+void TextureStreamer::startStreaming(StreamedTexture &texture, uint32_t level) {
+    // dropping levels could copy from the resident image instead, but reading the file keeps one path
+    texture.pendingLevel = level;
+    texture.pending = threadPool.submit(
+        [device = &device, info = texture.info, level] { return util::loadStagedTexture(device, info, level); });
+}
+
+void TextureStreamer::submitUpload(StreamedTexture &texture) {
+    try {
+        texture.uploadStaged = texture.pending.get();
+    } catch (const std::exception &e) {
+        // keep what is resident, finer levels are retried once they are requested again
+        std::cerr << "failed to stream texture " << texture.info.path << ": " << e.what() << std::endl;
+        std::fill(texture.lastRequested.begin(), texture.lastRequested.begin() + texture.residentLevel, 0);
+        return;
+    }
+
+    if (texture.uploadCommands == VK_NULL_HANDLE) {
+        VkCommandBufferAllocateInfo allocInfo{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO};
+        allocInfo.commandPool = uploadPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device.device(), &allocInfo, &texture.uploadCommands) != VK_SUCCESS) {
+            throw std::runtime_error("failed to allocate texture upload command buffer");
+        }
+        VkFenceCreateInfo fenceInfo{.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO};
+        if (vkCreateFence(device.device(), &fenceInfo, nullptr, &texture.uploadFence) != VK_SUCCESS) {
+            throw std::runtime_error("failed to create texture upload fence");
+        }
+    } else {
+        // the previous upload's fence was seen signaled before it was swapped in
+        vkResetFences(device.device(), 1, &texture.uploadFence);
+        vkResetCommandBuffer(texture.uploadCommands, 0);
+    }
+
+    VkCommandBufferBeginInfo beginInfo = init::commandBufferBeginInfo(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+    if (vkBeginCommandBuffer(texture.uploadCommands, &beginInfo) != VK_SUCCESS) {
+        throw std::runtime_error("failed to begin texture upload command buffer");
+    }
+    util::recordStagedTextureUpload(&device, texture.uploadCommands, texture.uploadStaged, texture.uploadImage);
+    if (vkEndCommandBuffer(texture.uploadCommands) != VK_SUCCESS) {
+        throw std::runtime_error("failed to record texture upload command buffer");
+    }
+
+    // submitted on its own, the frame being recorded keeps sampling the resident image
+    VkSubmitInfo submitInfo{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO};
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &texture.uploadCommands;
+    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, texture.uploadFence) != VK_SUCCESS) {
+        throw std::runtime_error("failed to submit texture upload");
+    }
+    texture.uploading = true;
+}
+
+void TextureStreamer::finishUpload(StreamedTexture &texture) {
+    util::destroyStagedTexture(&device, texture.uploadStaged);
+    retireImage(texture);
+
+    texture.image = texture.uploadImage;
+    texture.uploadImage = {};
+    texture.uploading = false;
+    texture.residentLevel = texture.pendingLevel;
+    texture.residentBytes = imageSize(texture.image);
+    bindlessSet.setTexture(texture.bindlessIndex, texture.image);
+}
+
+void TextureStreamer::dropToTail(StreamedTexture &texture) {
+    // the cached tail is still resident, so evicting everything above it needs no upload
+    retireImage(texture);
+    texture.image = *texture.tail;
+    texture.residentLevel = texture.tailLevel;
+    texture.residentBytes = imageSize(texture.image);
+    bindlessSet.setTexture(texture.bindlessIndex, texture.image);
+}
+
+void TextureStreamer::retireImage(StreamedTexture &texture) {
+    if (texture.image.image != texture.tail->image) {
+        retiredImages.push_back({texture.image, frameNumber});
+    }
+}
+
+VkDeviceSize TextureStreamer::imageSize(const AllocatedImage &image) {
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(device.device(), image.image, &memRequirements);
+    return memRequirements.size;
+}
+} // namespace lve
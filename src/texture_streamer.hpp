@@ -0,0 +1,103 @@
+#pragma once
+
+#include "asset_cache.hpp"
+#include "bindless_set.hpp"
+#include "lve_device.hpp"
+#include "lve_swap_chain.hpp"
+#include "lve_types.hpp"
+#include "utility/images.hpp"
+#include "utility/thread_pool.hpp"
+
+// std
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lve {
+// Streams the mip levels of bindless textures from the feedback the fragment shader writes into
+// BindlessSet. A texture starts with only its mip tail resident, the tail comes from AssetCache and is
+// shared with anyone else streaming the same file. When frames ask for finer levels
+// a job on the thread pool reads those levels into staging memory, the render thread submits the
+// copy into a new image and swaps that image in once the copy's fence has signaled, the render
+// thread never waits for the GPU. Levels nobody asked for within the eviction window are dropped
+// the same way, so the memory is actually returned.
+class TextureStreamer {
+public:
+    // levels whose edges are at most this many texels stay resident for the texture's lifetime
+    static constexpr uint32_t MIN_RESIDENT_SIZE = 64;
+
+    TextureStreamer(LveDevice &device, util::ThreadPool &threadPool, AssetCache &assetCache, BindlessSet &bindlessSet);
+    ~TextureStreamer();
+
+    // Not copyable or movable
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer operator=(const TextureStreamer &) = delete;
+    TextureStreamer(TextureStreamer &&) = delete;
+    TextureStreamer &operator=(TextureStreamer &&) = delete;
+
+    // uploads only the mip tail and returns the texture's bindless index
+    uint32_t addTexture(const std::string &path);
+    // call once per frame after the frame was acquired and before its set is bound
+    void update(uint32_t currentFrame);
+    void showGui();
+
+private:
+    struct StreamedTexture {
+        util::TextureInfo info;
+        uint32_t bindlessIndex;
+        uint32_t levelCount;
+        uint32_t tailLevel;
+
+        // owned by the cache, image is this one whenever only the tail is resident
+        std::shared_ptr<AllocatedImage> tail;
+        // mip 0 of the image is residentLevel of the full texture
+        AllocatedImage image;
+        uint32_t residentLevel;
+        VkDeviceSize residentBytes;
+
+        uint32_t requestedLevel;
+        // frame number each level was last requested in, 0 if never
+        std::vector<uint64_t> lastRequested;
+        // residentLevel each frame's set was recorded with, feedback is relative to it
+        std::vector<uint32_t> recordedLevel;
+
+        std::future<util::StagedTexture> pending;
+        uint32_t pendingLevel;
+
+        // the staged levels being copied into uploadImage, swapped in once uploadFence signals
+        bool uploading = false;
+        util::StagedTexture uploadStaged;
+        AllocatedImage uploadImage;
+        VkCommandBuffer uploadCommands = VK_NULL_HANDLE;
+        VkFence uploadFence = VK_NULL_HANDLE;
+    };
+
+    struct RetiredImage {
+        AllocatedImage image;
+        uint64_t frame;
+    };
+
+    uint32_t desiredLevel(const StreamedTexture &texture);
+    void startStreaming(StreamedTexture &texture, uint32_t level);
+    void submitUpload(StreamedTexture &texture);
+    void finishUpload(StreamedTexture &texture);
+    void dropToTail(StreamedTexture &texture);
+    // the tail is never destroyed here, the cache does that once its handle is released
+    void retireImage(StreamedTexture &texture);
+    VkDeviceSize imageSize(const AllocatedImage &image);
+
+    LveDevice &device;
+    util::ThreadPool &threadPool;
+    AssetCache &assetCache;
+    BindlessSet &bindlessSet;
+    // upload command buffers, one per texture and reused for each of its uploads
+    VkCommandPool uploadPool;
+
+    std::vector<std::unique_ptr<StreamedTexture>> textures;
+    std::vector<RetiredImage> retiredImages;
+    uint64_t frameNumber = 0;
+    int evictAfterFrames = 240;
+};
+} // namespace lve
@@ -1,11 +1,69 @@
 #include "images.hpp"
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+// stb_image always allocates its own output. While a decode into staging memory is armed on the
+// calling thread, the allocation sized like the decoded image is served from the mapped staging
+// buffer instead, so pixels are written there directly. Any other allocation goes to the heap, and
+// if stb_image ends up returning a different buffer the caller copies it over.
+struct StagingAllocation {
+    void *memory;
+    size_t size;
+    size_t capacity;
+    bool inUse;
+};
+
+thread_local StagingAllocation *stagingAllocation = nullptr;
+
+void *stbiMalloc(size_t size) {
+    if (stagingAllocation && !stagingAllocation->inUse && size >= stagingAllocation->size &&
+        size <= stagingAllocation->capacity) {
+        stagingAllocation->inUse = true;
+        return stagingAllocation->memory;
+    }
+    return malloc(size);
+}
+
+void *stbiRealloc(void *pointer, size_t newSize) {
+    if (!pointer) {
+        return stbiMalloc(newSize);
+    }
+    if (stagingAllocation && pointer == stagingAllocation->memory) {
+        // the staging buffer cannot grow, move the data to the heap
+        void *moved = malloc(newSize);
+        if (moved) {
+            memcpy(moved, pointer, std::min(newSize, stagingAllocation->capacity));
+            stagingAllocation->inUse = false;
+        }
+        return moved;
+    }
+    return realloc(pointer, newSize);
+}
+
+void stbiFree(void *pointer) {
+    if (stagingAllocation && pointer == stagingAllocation->memory) {
+        stagingAllocation->inUse = false;
+        return;
+    }
+    free(pointer);
+}
+} // namespace
+
+#define STBI_MALLOC(size) stbiMalloc(size)
+#define STBI_REALLOC(pointer, size) stbiRealloc(pointer, size)
+#define STBI_FREE(pointer) stbiFree(pointer)
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
 #include "../initializers/images.hpp"
-
-#include <stdexcept>
+#include "ktx2.hpp"
 
 namespace util {
 void copyImageToImage(VkCommandBuffer commandBuffer, VkImage source, VkImage destination,
@@ -43,7 +101,7 @@ void copyImageToImage(VkCommandBuffer commandBuffer, VkImage source, VkImage des
 }
 
 void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format,
-                           VkImageLayout oldLayout, VkImageLayout newLayout) {
+                           VkImageLayout oldLayout, VkImageLayout newLayout, uint32_t mipLevels) {
     VkImageMemoryBarrier barrier{};
     barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
     barrier.oldLayout = oldLayout;
@@ -53,7 +111,7 @@ void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkForma
     barrier.image = image;
     barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
     barrier.subresourceRange.baseMipLevel = 0;
-    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.levelCount = mipLevels;
     barrier.subresourceRange.baseArrayLayer = 0;
     barrier.subresourceRange.layerCount = 1;
     barrier.srcAccessMask = 0;
@@ -88,49 +146,268 @@ void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkForma
                          &barrier);
 }
 
-void loadTextureImage(lve::LveDevice *lveDevice, std::string texturePath,
-                      lve::AllocatedImage &outImage) {
+void generateMipmaps(VkCommandBuffer commandBuffer, VkImage image, uint32_t width,
+                     uint32_t height, uint32_t mipLevels) {
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    int32_t mipWidth = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+
+        VkImageBlit blit{};
+        blit.srcOffsets[1] = {mipWidth, mipHeight, 1};
+        blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+        blit.dstOffsets[1] = {std::max(mipWidth / 2, 1), std::max(mipHeight / 2, 1), 1};
+        blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+        vkCmdBlitImage(commandBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, image,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+        barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                             VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                             &barrier);
+
+        mipWidth = std::max(mipWidth / 2, 1);
+        mipHeight = std::max(mipHeight / 2, 1);
+    }
+
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 1,
+                         &barrier);
+}
+
+TextureInfo readTextureInfo(lve::LveDevice *lveDevice, const std::string &texturePath) {
+    // prefer a cooked texture next to the source image when the device can sample its format
+    std::filesystem::path cookedPath = std::filesystem::path{texturePath}.replace_extension(".ktx2");
+    TextureInfo info;
+    if (std::filesystem::exists(cookedPath) && readKtx2Info(lveDevice, cookedPath.string(), info)) {
+        return info;
+    }
+
     int texWidth, texHeight, texChannels;
-    stbi_uc *pixels =
-        stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    if (!stbi_info(texturePath.c_str(), &texWidth, &texHeight, &texChannels)) {
+        throw std::runtime_error("failed to load texture image: " + texturePath);
+    }
+
+    info.path = texturePath;
+    info.ktx2 = false;
+    info.format = VK_FORMAT_R8G8B8A8_SRGB;
+    info.width = static_cast<uint32_t>(texWidth);
+    info.height = static_cast<uint32_t>(texHeight);
+    info.levels.push_back({0, static_cast<size_t>(texWidth) * texHeight * 4});
+    return info;
+}
+
+bool readKtx2Info(lve::LveDevice *lveDevice, const std::string &texturePath, TextureInfo &outInfo) {
+    std::ifstream file{texturePath, std::ios::ate | std::ios::binary};
+    if (!file.is_open()) {
+        throw std::runtime_error("failed to open file: " + texturePath);
+    }
+
+    size_t fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize < sizeof(Ktx2Header)) {
+        throw std::runtime_error("invalid KTX2 file: " + texturePath);
+    }
+
+    Ktx2Header header;
+    file.seekg(0);
+    file.read(reinterpret_cast<char *>(&header), sizeof(header));
+    if (memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        throw std::runtime_error("invalid KTX2 file: " + texturePath);
+    }
+    if (header.supercompressionScheme != 0 || header.pixelDepth > 1 || header.layerCount > 1 ||
+        header.faceCount != 1) {
+        throw std::runtime_error("unsupported KTX2 layout: " + texturePath);
+    }
+
+    VkFormat format = static_cast<VkFormat>(header.vkFormat);
+    if (!lveDevice->isFormatSupported(format, VK_IMAGE_TILING_OPTIMAL,
+                                      VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                                          VK_FORMAT_FEATURE_TRANSFER_DST_BIT)) {
+        return false;
+    }
+
+    uint32_t mipLevels = std::max(1u, header.levelCount);
+    if (sizeof(Ktx2Header) + mipLevels * sizeof(Ktx2LevelIndex) > fileSize) {
+        throw std::runtime_error("invalid KTX2 level index: " + texturePath);
+    }
+    std::vector<Ktx2LevelIndex> levels(mipLevels);
+    file.read(reinterpret_cast<char *>(levels.data()), mipLevels * sizeof(Ktx2LevelIndex));
 
-    if (!pixels) {
-        throw std::runtime_error("failed to load texture image");
+    outInfo.path = texturePath;
+    outInfo.ktx2 = true;
+    outInfo.format = format;
+    outInfo.width = header.pixelWidth;
+    outInfo.height = header.pixelHeight;
+    outInfo.levels.clear();
+    for (const Ktx2LevelIndex &level : levels) {
+        if (level.byteOffset + level.byteLength > fileSize) {
+            throw std::runtime_error("invalid KTX2 level data: " + texturePath);
+        }
+        outInfo.levels.push_back(
+            {static_cast<size_t>(level.byteOffset), static_cast<size_t>(level.byteLength)});
     }
+    return true;
+}
 
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
+VkDeviceSize stagingSize(const TextureInfo &info, uint32_t firstLevel) {
+    // levels are packed into the staging buffer largest first, 16 byte aligned for any block size
+    VkDeviceSize size = 0;
+    for (uint32_t level = firstLevel; level < info.levels.size(); level++) {
+        size += (info.levels[level].size + 15) & ~VkDeviceSize{15};
+    }
+    // stb_image's jpeg decoder allocates one byte past the image
+    return info.ktx2 ? size : size + 16;
+}
 
-    lveDevice->createBuffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+StagedTexture loadStagedTexture(lve::LveDevice *lveDevice, const TextureInfo &info,
+                                uint32_t firstLevel) {
+    uint32_t levelCount = static_cast<uint32_t>(info.levels.size());
+    if (firstLevel >= levelCount) {
+        throw std::runtime_error("failed to stage texture, mip level out of range");
+    }
+
+    StagedTexture staged;
+    staged.format = info.format;
+    staged.width = std::max(1u, info.width >> firstLevel);
+    staged.height = std::max(1u, info.height >> firstLevel);
+
+    staged.regions.resize(levelCount - firstLevel);
+    VkDeviceSize offset = 0;
+    for (uint32_t level = 0; level < staged.regions.size(); level++) {
+        VkBufferImageCopy &region = staged.regions[level];
+        region = {};
+        region.bufferOffset = offset;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = {0, 0, 0};
+        region.imageExtent = {std::max(1u, staged.width >> level),
+                              std::max(1u, staged.height >> level), 1};
+
+        offset += (info.levels[firstLevel + level].size + 15) & ~VkDeviceSize{15};
+    }
+
+    VkDeviceSize bufferSize = stagingSize(info, firstLevel);
+    lveDevice->createBuffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
                             VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT |
                                 VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                            stagingBuffer, stagingBufferMemory);
+                            staged.buffer, staged.memory);
 
-    void *data;
-    vkMapMemory(lveDevice->device(), stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
-    vkUnmapMemory(lveDevice->device(), stagingBufferMemory);
-    stbi_image_free(pixels);
+    uint8_t *data;
+    vkMapMemory(lveDevice->device(), staged.memory, 0, bufferSize, 0,
+                reinterpret_cast<void **>(&data));
+    try {
+        if (info.ktx2) {
+            // level data is stored as is, read each level straight into place
+            std::ifstream file{info.path, std::ios::binary};
+            if (!file.is_open()) {
+                throw std::runtime_error("failed to open file: " + info.path);
+            }
+            for (uint32_t level = 0; level < staged.regions.size(); level++) {
+                const TextureInfo::Level &source = info.levels[firstLevel + level];
+                file.seekg(static_cast<std::streamoff>(source.offset));
+                file.read(reinterpret_cast<char *>(data + staged.regions[level].bufferOffset),
+                          static_cast<std::streamsize>(source.size));
+                if (!file) {
+                    throw std::runtime_error("failed to read KTX2 level data: " + info.path);
+                }
+            }
+        } else {
+            StagingAllocation allocation{data, info.levels[0].size, bufferSize, false};
+            stagingAllocation = &allocation;
+            int texWidth, texHeight, texChannels;
+            stbi_uc *pixels =
+                stbi_load(info.path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+            bool sizeMatches = pixels && static_cast<uint32_t>(texWidth) == info.width &&
+                               static_cast<uint32_t>(texHeight) == info.height;
+            if (pixels && pixels != data) {
+                if (sizeMatches) {
+                    memcpy(data, pixels, info.levels[0].size);
+                }
+                stbi_image_free(pixels);
+            }
+            stagingAllocation = nullptr;
 
-    VkCommandBuffer commandBuffer = lveDevice->beginSingleTimeCommands();
-    init::createImage(lveDevice, texWidth, texHeight, VK_FORMAT_R8G8B8A8_SRGB,
+            if (!pixels) {
+                throw std::runtime_error("failed to load texture image: " + info.path);
+            }
+            if (!sizeMatches) {
+                throw std::runtime_error("texture image changed while loading: " + info.path);
+            }
+        }
+    } catch (...) {
+        vkUnmapMemory(lveDevice->device(), staged.memory);
+        destroyStagedTexture(lveDevice, staged);
+        throw;
+    }
+    vkUnmapMemory(lveDevice->device(), staged.memory);
+    return staged;
+}
+
+void recordStagedTextureUpload(lve::LveDevice *lveDevice, VkCommandBuffer commandBuffer,
+                               const StagedTexture &staged, lve::AllocatedImage &outImage) {
+    uint32_t mipLevels = static_cast<uint32_t>(staged.regions.size());
+    init::createImage(lveDevice, staged.width, staged.height, staged.format,
                       VK_IMAGE_TILING_OPTIMAL,
                       VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outImage);
-    util::transitionImageLayout(commandBuffer, outImage.image, VK_FORMAT_R8G8B8A8_SRGB,
-                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-    lveDevice->endSingleTimeCommands(commandBuffer);
+                      VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, outImage, mipLevels);
 
-    lveDevice->copyBufferToImage(stagingBuffer, outImage.image, static_cast<uint32_t>(texWidth),
-                                 static_cast<uint32_t>(texHeight), 1);
-    commandBuffer = lveDevice->beginSingleTimeCommands();
-    util::transitionImageLayout(commandBuffer, outImage.image, VK_FORMAT_R8G8B8A8_SRGB,
+    util::transitionImageLayout(commandBuffer, outImage.image, staged.format,
+                                VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                                mipLevels);
+    vkCmdCopyBufferToImage(commandBuffer, staged.buffer, outImage.image,
+                           VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels,
+                           staged.regions.data());
+    util::transitionImageLayout(commandBuffer, outImage.image, staged.format,
                                 VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+                                VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+}
+
+void uploadStagedTexture(lve::LveDevice *lveDevice, StagedTexture &staged,
+                         lve::AllocatedImage &outImage) {
+    VkCommandBuffer commandBuffer = lveDevice->beginSingleTimeCommands();
+    recordStagedTextureUpload(lveDevice, commandBuffer, staged, outImage);
     lveDevice->endSingleTimeCommands(commandBuffer);
 
-    vkDestroyBuffer(lveDevice->device(), stagingBuffer, nullptr);
-    vkFreeMemory(lveDevice->device(), stagingBufferMemory, nullptr);
+    destroyStagedTexture(lveDevice, staged);
+}
+
+void destroyStagedTexture(lve::LveDevice *lveDevice, StagedTexture &staged) {
+    vkDestroyBuffer(lveDevice->device(), staged.buffer, nullptr);
+    vkFreeMemory(lveDevice->device(), staged.memory, nullptr);
+    staged.buffer = VK_NULL_HANDLE;
+    staged.memory = VK_NULL_HANDLE;
+}
+
+void loadTextureImage(lve::LveDevice *lveDevice, std::string texturePath,
+                      lve::AllocatedImage &outImage) {
+    StagedTexture staged = loadStagedTexture(lveDevice, readTextureInfo(lveDevice, texturePath));
+    uploadStagedTexture(lveDevice, staged, outImage);
 }
-} // namespace util
\ No newline at end of file
+} // namespace util
@@ -3,11 +3,61 @@
 #include "../lve_device.hpp"
 #include "../lve_types.hpp"
 
+#include <string>
+#include <vector>
+
 namespace util {
+// header of a texture file, resolved to its cooked KTX2 sibling when the device can sample that
+struct TextureInfo {
+    struct Level {
+        size_t offset;
+        size_t size;
+    };
+
+    std::string path;
+    bool ktx2 = false;
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    // byte ranges in a KTX2 file, or the single decoded level of any other image
+    std::vector<Level> levels;
+};
+
+// mip levels copied into a host visible buffer, ready to be recorded into an image upload
+struct StagedTexture {
+    VkBuffer buffer = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkFormat format;
+    uint32_t width;
+    uint32_t height;
+    std::vector<VkBufferImageCopy> regions;
+};
+
 void copyImageToImage(VkCommandBuffer commandBuffer, VkImage source, VkImage destination,
                       VkExtent2D srcSize, VkExtent2D dstSize);
 void loadTextureImage(lve::LveDevice *lveDevice, std::string texturePath,
                       lve::AllocatedImage &outImage);
+TextureInfo readTextureInfo(lve::LveDevice *lveDevice, const std::string &texturePath);
+bool readKtx2Info(lve::LveDevice *lveDevice, const std::string &texturePath,
+                  TextureInfo &outInfo);
+VkDeviceSize stagingSize(const TextureInfo &info, uint32_t firstLevel = 0);
+// reserves staging memory sized from the header and decodes or reads levels from firstLevel down
+// straight into it, the staged texture's base level is firstLevel. Safe to call on any thread.
+StagedTexture loadStagedTexture(lve::LveDevice *lveDevice, const TextureInfo &info,
+                                uint32_t firstLevel = 0);
+// creates outImage and records copying the staged levels into it, the staging buffer has to stay
+// alive until commandBuffer has finished
+void recordStagedTextureUpload(lve::LveDevice *lveDevice, VkCommandBuffer commandBuffer,
+                               const StagedTexture &staged, lve::AllocatedImage &outImage);
+// creates outImage from the staged levels, waits for the upload and frees the staging buffer
+void uploadStagedTexture(lve::LveDevice *lveDevice, StagedTexture &staged,
+                         lve::AllocatedImage &outImage);
+void destroyStagedTexture(lve::LveDevice *lveDevice, StagedTexture &staged);
 void transitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format,
-                           VkImageLayout oldLayout, VkImageLayout newLayout);
+                           VkImageLayout oldLayout, VkImageLayout newLayout,
+                           uint32_t mipLevels = 1);
+// fills levels 1 and up by blitting down from level 0, every level must be in
+// TRANSFER_DST_OPTIMAL and ends up in SHADER_READ_ONLY_OPTIMAL
+void generateMipmaps(VkCommandBuffer commandBuffer, VkImage image, uint32_t width,
+                     uint32_t height, uint32_t mipLevels);
 } // namespace util
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+
+// KTX2 container layout shared by the runtime loader and tools/texture_cooker.
+// Only the subset we produce is described here: 2D, single layer, single face,
+// no supercompression.
+namespace util {
+constexpr uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+// VkFormat values written by the cooker, kept numeric so the cooker does not need the Vulkan headers
+enum Ktx2Format : uint32_t {
+    KTX2_FORMAT_R8G8B8A8_UNORM = 37,
+    KTX2_FORMAT_R8G8B8A8_SRGB = 43,
+    KTX2_FORMAT_BC1_RGBA_UNORM = 133,
+    KTX2_FORMAT_BC1_RGBA_SRGB = 134,
+    KTX2_FORMAT_BC3_UNORM = 137,
+    KTX2_FORMAT_BC3_SRGB = 138,
+    KTX2_FORMAT_BC5_UNORM = 141,
+    KTX2_FORMAT_BC7_UNORM = 145,
+    KTX2_FORMAT_BC7_SRGB = 146,
+};
+
+struct Ktx2Header {
+    uint8_t identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t pixelWidth;
+    uint32_t pixelHeight;
+    uint32_t pixelDepth;
+    uint32_t layerCount;
+    uint32_t faceCount;
+    uint32_t levelCount;
+    uint32_t supercompressionScheme;
+
+    uint32_t dfdByteOffset;
+    uint32_t dfdByteLength;
+    uint32_t kvdByteOffset;
+    uint32_t kvdByteLength;
+    uint64_t sgdByteOffset;
+    uint64_t sgdByteLength;
+};
+static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+
+struct Ktx2LevelIndex {
+    uint64_t byteOffset;
+    uint64_t byteLength;
+    uint64_t uncompressedByteLength;
+};
+static_assert(sizeof(Ktx2LevelIndex) == 24, "KTX2 level index must match the file layout");
+
+// bytes per 4x4 block for compressed formats, bytes per texel otherwise
+inline uint32_t ktx2BlockSize(uint32_t vkFormat) {
+    switch (vkFormat) {
+    case KTX2_FORMAT_BC1_RGBA_UNORM:
+    case KTX2_FORMAT_BC1_RGBA_SRGB:
+        return 8;
+    case KTX2_FORMAT_BC3_UNORM:
+    case KTX2_FORMAT_BC3_SRGB:
+    case KTX2_FORMAT_BC5_UNORM:
+    case KTX2_FORMAT_BC7_UNORM:
+    case KTX2_FORMAT_BC7_SRGB:
+        return 16;
+    default:
+        return 4;
+    }
+}
+
+inline bool ktx2IsBlockCompressed(uint32_t vkFormat) { return vkFormat >= KTX2_FORMAT_BC1_RGBA_UNORM; }
+} // namespace util
@@ -0,0 +1,80 @@
+#include "texture_loader.hpp"
+
+// std
+#include <algorithm>
+#include <exception>
+
+namespace util {
+TextureLoader::TextureLoader(lve::LveDevice &device, ThreadPool &threadPool, size_t maxDecodedBytes)
+    : device{device}, threadPool{threadPool}, maxDecodedBytes{maxDecodedBytes} {}
+
+void TextureLoader::loadTextureImages(const std::vector<TextureRequest> &requests) {
+    for (size_t i = 0; i < requests.size(); i++) {
+        threadPool.submit([this, i, path = requests[i].path] {
+            DecodeResult result{.requestIndex = i, .reservedBytes = 0};
+            try {
+                TextureInfo info = readTextureInfo(&device, path);
+                result.reservedBytes = stagingSize(info);
+                reserveBudget(result.reservedBytes);
+                result.texture = loadStagedTexture(&device, info);
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock{mutex};
+            results.push_back(std::move(result));
+            resultAvailable.notify_one();
+        });
+    }
+
+    // upload in completion order, every job has to finish before returning even if one fails
+    std::exception_ptr firstError;
+    for (size_t uploaded = 0; uploaded < requests.size(); uploaded++) {
+        DecodeResult result;
+        {
+            std::unique_lock<std::mutex> lock{mutex};
+            resultAvailable.wait(lock, [this] { return !results.empty(); });
+            result = std::move(results.back());
+            results.pop_back();
+        }
+
+        if (!result.error) {
+            try {
+                uploadStagedTexture(&device, result.texture, *requests[result.requestIndex].outImage);
+            } catch (...) {
+                result.error = std::current_exception();
+            }
+        }
+        if (result.error && !firstError) {
+            firstError = result.error;
+        }
+
+        // free the staging buffer before handing the budget back
+        if (result.texture.buffer != VK_NULL_HANDLE) {
+            destroyStagedTexture(&device, result.texture);
+        }
+        releaseBudget(result.reservedBytes);
+    }
+
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+}
+
+void TextureLoader::reserveBudget(size_t bytes) {
+    // a single texture larger than the budget is let through once nothing else is in flight
+    bytes = std::min(bytes, maxDecodedBytes);
+    std::unique_lock<std::mutex> lock{mutex};
+    budgetAvailable.wait(lock, [this, bytes] { return decodedBytes + bytes <= maxDecodedBytes; });
+    decodedBytes += bytes;
+}
+
+void TextureLoader::releaseBudget(size_t bytes) {
+    bytes = std::min(bytes, maxDecodedBytes);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        decodedBytes -= bytes;
+    }
+    budgetAvailable.notify_all();
+}
+} // namespace util
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "../lve_device.hpp"
+#include "../lve_types.hpp"
+#include "images.hpp"
+#include "thread_pool.hpp"
+
+// std
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace util {
+struct TextureRequest {
+    std::string path;
+    lve::AllocatedImage *outImage;
+};
+
+// Decodes a batch of textures concurrently on the thread pool and uploads each one on the
+// calling thread as soon as it is ready. Textures are decoded straight into their staging
+// buffers, and staging memory waiting for upload is capped at maxDecodedBytes so large batches
+// do not spike memory.
+class TextureLoader {
+public:
+    static constexpr size_t DEFAULT_MAX_DECODED_BYTES = 256 * 1024 * 1024;
+
+    TextureLoader(lve::LveDevice &device, ThreadPool &threadPool,
+                  size_t maxDecodedBytes = DEFAULT_MAX_DECODED_BYTES);
+
+    TextureLoader(const TextureLoader &) = delete;
+    TextureLoader &operator=(const TextureLoader &) = delete;
+
+    void loadTextureImages(const std::vector<TextureRequest> &requests);
+
+private:
+    struct DecodeResult {
+        size_t requestIndex;
+        size_t reservedBytes;
+        StagedTexture texture;
+        std::exception_ptr error;
+    };
+
+    void reserveBudget(size_t bytes);
+    void releaseBudget(size_t bytes);
+
+    lve::LveDevice &device;
+    ThreadPool &threadPool;
+    const size_t maxDecodedBytes;
+
+    std::mutex mutex;
+    std::condition_variable budgetAvailable;
+    std::condition_variable resultAvailable;
+    size_t decodedBytes = 0;
+    std::vector<DecodeResult> results;
+};
+} // namespace util
@@ -0,0 +1,53 @@
+#pragma once
+
+// std
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace util {
+class ThreadPool {
+public:
+    explicit ThreadPool(uint32_t threadCount = defaultThreadCount());
+    ~ThreadPool();
+
+    // Not copyable or movable
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ThreadPool(ThreadPool &&) = delete;
+    ThreadPool &operator=(ThreadPool &&) = delete;
+
+    template <typename F> std::future<std::invoke_result_t<F>> submit(F &&task) {
+        using Result = std::invoke_result_t<F>;
+        auto packagedTask = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> future = packagedTask->get_future();
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            tasks.emplace([packagedTask] { (*packagedTask)(); });
+        }
+        condition.notify_one();
+        return future;
+    }
+
+    uint32_t threadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+    // leaves one core for the render thread
+    static uint32_t defaultThreadCount() { return std::max(2u, std::thread::hardware_concurrency()) - 1; }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping = false;
+};
+} // namespace util
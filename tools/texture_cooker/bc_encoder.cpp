@@ -0,0 +1,356 @@
+#include "bc_encoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace cooker {
+namespace {
+constexpr int BLOCK_TEXELS = 16;
+
+struct Axis {
+    float mean[4];
+    float dir[4];
+    float minT;
+    float maxT;
+};
+
+// principal axis of the selected texels via power iteration on the covariance matrix
+Axis principalAxis(const uint8_t *rgba, int channels, const bool *mask) {
+    Axis axis{};
+    int count = 0;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        if (mask && !mask[i]) {
+            continue;
+        }
+        for (int c = 0; c < channels; c++) {
+            axis.mean[c] += rgba[i * 4 + c];
+        }
+        count++;
+    }
+    if (count == 0) {
+        return axis;
+    }
+    for (int c = 0; c < channels; c++) {
+        axis.mean[c] /= count;
+    }
+
+    float cov[4][4] = {};
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        if (mask && !mask[i]) {
+            continue;
+        }
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                cov[a][b] += (rgba[i * 4 + a] - axis.mean[a]) * (rgba[i * 4 + b] - axis.mean[b]);
+            }
+        }
+    }
+
+    float dir[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+    for (int iteration = 0; iteration < 8; iteration++) {
+        float next[4] = {};
+        float length = 0.0f;
+        for (int a = 0; a < channels; a++) {
+            for (int b = 0; b < channels; b++) {
+                next[a] += cov[a][b] * dir[b];
+            }
+            length += next[a] * next[a];
+        }
+        length = std::sqrt(length);
+        if (length < 1e-6f) {
+            break;
+        }
+        for (int a = 0; a < channels; a++) {
+            dir[a] = next[a] / length;
+        }
+    }
+
+    float length = 0.0f;
+    for (int c = 0; c < channels; c++) {
+        length += dir[c] * dir[c];
+    }
+    length = std::sqrt(length);
+    for (int c = 0; c < channels; c++) {
+        axis.dir[c] = dir[c] / length;
+    }
+
+    axis.minT = 1e30f;
+    axis.maxT = -1e30f;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        if (mask && !mask[i]) {
+            continue;
+        }
+        float t = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            t += (rgba[i * 4 + c] - axis.mean[c]) * axis.dir[c];
+        }
+        axis.minT = std::min(axis.minT, t);
+        axis.maxT = std::max(axis.maxT, t);
+    }
+    return axis;
+}
+
+uint16_t packRGB565(const float *color) {
+    uint16_t r = static_cast<uint16_t>(std::clamp(std::lround(color[0] * 31.0f / 255.0f), 0L, 31L));
+    uint16_t g = static_cast<uint16_t>(std::clamp(std::lround(color[1] * 63.0f / 255.0f), 0L, 63L));
+    uint16_t b = static_cast<uint16_t>(std::clamp(std::lround(color[2] * 31.0f / 255.0f), 0L, 31L));
+    return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+}
+
+void unpackRGB565(uint16_t packed, int *outColor) {
+    int r = (packed >> 11) & 31;
+    int g = (packed >> 5) & 63;
+    int b = packed & 31;
+    outColor[0] = (r << 3) | (r >> 2);
+    outColor[1] = (g << 2) | (g >> 4);
+    outColor[2] = (b << 3) | (b >> 2);
+}
+
+int colorDistance(const uint8_t *texel, const int *color) {
+    int dr = texel[0] - color[0];
+    int dg = texel[1] - color[1];
+    int db = texel[2] - color[2];
+    return dr * dr + dg * dg + db * db;
+}
+
+void writeLE16(uint8_t *out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void writeLE32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// BC1 colour block; punchThrough enables the 3-colour + transparent mode for texels with alpha < 128
+void encodeColorBlock(const uint8_t *rgba, uint8_t *outBlock, bool punchThrough) {
+    bool opaque[BLOCK_TEXELS];
+    bool anyTransparent = false;
+    bool anyOpaque = false;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        opaque[i] = !punchThrough || rgba[i * 4 + 3] >= 128;
+        anyTransparent |= !opaque[i];
+        anyOpaque |= opaque[i];
+    }
+
+    if (!anyOpaque) {
+        writeLE16(outBlock, 0);
+        writeLE16(outBlock + 2, 0);
+        writeLE32(outBlock + 4, 0xFFFFFFFFu);
+        return;
+    }
+
+    Axis axis = principalAxis(rgba, 3, opaque);
+    float endpointA[3], endpointB[3];
+    for (int c = 0; c < 3; c++) {
+        endpointA[c] = axis.mean[c] + axis.dir[c] * axis.maxT;
+        endpointB[c] = axis.mean[c] + axis.dir[c] * axis.minT;
+    }
+
+    uint16_t color0 = packRGB565(endpointA);
+    uint16_t color1 = packRGB565(endpointB);
+    // 4-colour mode needs color0 > color1, 3-colour mode needs color0 <= color1
+    if ((anyTransparent && color0 > color1) || (!anyTransparent && color0 < color1)) {
+        std::swap(color0, color1);
+    }
+
+    int palette[4][3];
+    unpackRGB565(color0, palette[0]);
+    unpackRGB565(color1, palette[1]);
+    int paletteSize;
+    if (color0 > color1) {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        paletteSize = 4;
+    } else {
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+        paletteSize = 3;
+    }
+
+    uint32_t indices = 0;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        uint32_t best = 3;
+        if (opaque[i]) {
+            int bestDistance = colorDistance(rgba + i * 4, palette[0]);
+            best = 0;
+            for (int p = 1; p < paletteSize; p++) {
+                int distance = colorDistance(rgba + i * 4, palette[p]);
+                if (distance < bestDistance) {
+                    bestDistance = distance;
+                    best = p;
+                }
+            }
+        }
+        indices |= best << (2 * i);
+    }
+
+    writeLE16(outBlock, color0);
+    writeLE16(outBlock + 2, color1);
+    writeLE32(outBlock + 4, indices);
+}
+
+// BC4 single channel block, always in the 8-value mode
+void encodeChannelBlock(const uint8_t *rgba, int channel, uint8_t *outBlock) {
+    uint8_t minValue = 255;
+    uint8_t maxValue = 0;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        minValue = std::min(minValue, rgba[i * 4 + channel]);
+        maxValue = std::max(maxValue, rgba[i * 4 + channel]);
+    }
+
+    outBlock[0] = maxValue;
+    outBlock[1] = minValue;
+
+    int palette[8];
+    palette[0] = maxValue;
+    palette[1] = minValue;
+    for (int p = 1; p < 7; p++) {
+        palette[p + 1] = ((7 - p) * maxValue + p * minValue) / 7;
+    }
+
+    uint64_t indices = 0;
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        int value = rgba[i * 4 + channel];
+        uint64_t best = 0;
+        int bestDistance = std::abs(value - palette[0]);
+        for (int p = 1; p < 8 && maxValue != minValue; p++) {
+            int distance = std::abs(value - palette[p]);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                best = p;
+            }
+        }
+        indices |= best << (3 * i);
+    }
+
+    for (int i = 0; i < 6; i++) {
+        outBlock[2 + i] = static_cast<uint8_t>(indices >> (8 * i));
+    }
+}
+
+class BitWriter {
+public:
+    explicit BitWriter(uint8_t *out) : out{out} { std::memset(out, 0, 16); }
+
+    void write(uint32_t value, int bits) {
+        for (int i = 0; i < bits; i++, position++) {
+            if (value & (1u << i)) {
+                out[position / 8] |= static_cast<uint8_t>(1u << (position % 8));
+            }
+        }
+    }
+
+private:
+    uint8_t *out;
+    int position = 0;
+};
+
+constexpr int BC7_WEIGHTS4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// quantizes an RGBA endpoint to 7 bits per channel plus a shared p-bit, returning the reconstruction error
+int quantizeBC7Endpoint(const float *endpoint, int *outQuantized, int &outPBit) {
+    int bestError = -1;
+    for (int p = 0; p < 2; p++) {
+        int quantized[4];
+        int error = 0;
+        for (int c = 0; c < 4; c++) {
+            quantized[c] = static_cast<int>(std::clamp(std::lround((endpoint[c] - p) / 2.0f), 0L, 127L));
+            int reconstructed = (quantized[c] << 1) | p;
+            error += static_cast<int>((reconstructed - endpoint[c]) * (reconstructed - endpoint[c]));
+        }
+        if (bestError < 0 || error < bestError) {
+            bestError = error;
+            outPBit = p;
+            std::memcpy(outQuantized, quantized, sizeof(quantized));
+        }
+    }
+    return bestError;
+}
+} // namespace
+
+void encodeBC1(const uint8_t *rgba, uint8_t *outBlock) { encodeColorBlock(rgba, outBlock, true); }
+
+void encodeBC3(const uint8_t *rgba, uint8_t *outBlock) {
+    encodeChannelBlock(rgba, 3, outBlock);
+    encodeColorBlock(rgba, outBlock + 8, false);
+}
+
+void encodeBC5(const uint8_t *rgba, uint8_t *outBlock) {
+    encodeChannelBlock(rgba, 0, outBlock);
+    encodeChannelBlock(rgba, 1, outBlock + 8);
+}
+
+void encodeBC7(const uint8_t *rgba, uint8_t *outBlock) {
+    Axis axis = principalAxis(rgba, 4, nullptr);
+    float endpoints[2][4];
+    for (int c = 0; c < 4; c++) {
+        endpoints[0][c] = std::clamp(axis.mean[c] + axis.dir[c] * axis.minT, 0.0f, 255.0f);
+        endpoints[1][c] = std::clamp(axis.mean[c] + axis.dir[c] * axis.maxT, 0.0f, 255.0f);
+    }
+
+    int quantized[2][4];
+    int pBits[2];
+    int palette[16][4];
+    for (int e = 0; e < 2; e++) {
+        quantizeBC7Endpoint(endpoints[e], quantized[e], pBits[e]);
+    }
+
+    int expanded[2][4];
+    for (int e = 0; e < 2; e++) {
+        for (int c = 0; c < 4; c++) {
+            expanded[e][c] = (quantized[e][c] << 1) | pBits[e];
+        }
+    }
+    for (int p = 0; p < 16; p++) {
+        for (int c = 0; c < 4; c++) {
+            palette[p][c] = ((64 - BC7_WEIGHTS4[p]) * expanded[0][c] + BC7_WEIGHTS4[p] * expanded[1][c] + 32) >> 6;
+        }
+    }
+
+    int indices[BLOCK_TEXELS];
+    for (int i = 0; i < BLOCK_TEXELS; i++) {
+        int bestDistance = -1;
+        for (int p = 0; p < 16; p++) {
+            int distance = 0;
+            for (int c = 0; c < 4; c++) {
+                int delta = rgba[i * 4 + c] - palette[p][c];
+                distance += delta * delta;
+            }
+            if (bestDistance < 0 || distance < bestDistance) {
+                bestDistance = distance;
+                indices[i] = p;
+            }
+        }
+    }
+
+    // the anchor index is stored with its top bit implied to be zero
+    if (indices[0] & 8) {
+        std::swap(quantized[0], quantized[1]);
+        std::swap(pBits[0], pBits[1]);
+        for (int &index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BitWriter writer{outBlock};
+    writer.write(1u << 6, 7);
+    for (int c = 0; c < 4; c++) {
+        writer.write(quantized[0][c], 7);
+        writer.write(quantized[1][c], 7);
+    }
+    writer.write(pBits[0], 1);
+    writer.write(pBits[1], 1);
+    writer.write(indices[0], 3);
+    for (int i = 1; i < BLOCK_TEXELS; i++) {
+        writer.write(indices[i], 4);
+    }
+}
+} // namespace cooker
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+namespace cooker {
+// Each encoder takes a 4x4 block of RGBA8 texels in row-major order (64 bytes)
+// and writes one compressed block to outBlock.
+void encodeBC1(const uint8_t *rgba, uint8_t *outBlock);  // 8 bytes, punch-through alpha
+void encodeBC3(const uint8_t *rgba, uint8_t *outBlock);  // 16 bytes
+void encodeBC5(const uint8_t *rgba, uint8_t *outBlock);  // 16 bytes, red and green only
+void encodeBC7(const uint8_t *rgba, uint8_t *outBlock);  // 16 bytes, mode 6
+} // namespace cooker
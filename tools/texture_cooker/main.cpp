@@ -0,0 +1,355 @@
+#include "bc_encoder.hpp"
+
+#include "../../src/utility/ktx2.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+// std
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Converts source images into KTX2 textures with a baked mip chain.
+//
+//   texture_cooker <input> <output.ktx2> [--format bc1|bc3|bc5|bc7|rgba8] [--linear] [--no-mips]
+//
+// bc7 is the default. rgba8 writes an uncompressed container for devices or
+// content that cannot use block compression.
+namespace cooker {
+namespace {
+enum class Format { BC1, BC3, BC5, BC7, RGBA8 };
+
+struct Options {
+    std::string inputPath;
+    std::string outputPath;
+    Format format = Format::BC7;
+    bool srgb = true;
+    bool mips = true;
+};
+
+struct MipLevel {
+    uint32_t width;
+    uint32_t height;
+    std::vector<uint8_t> rgba;
+};
+
+// KHR data format descriptor constants
+constexpr uint32_t KHR_DF_MODEL_RGBSDA = 1;
+constexpr uint32_t KHR_DF_MODEL_BC1A = 128;
+constexpr uint32_t KHR_DF_MODEL_BC3 = 130;
+constexpr uint32_t KHR_DF_MODEL_BC5 = 132;
+constexpr uint32_t KHR_DF_MODEL_BC7 = 134;
+constexpr uint32_t KHR_DF_PRIMARIES_BT709 = 1;
+constexpr uint32_t KHR_DF_TRANSFER_LINEAR = 1;
+constexpr uint32_t KHR_DF_TRANSFER_SRGB = 2;
+constexpr uint32_t KHR_DF_SAMPLE_DATATYPE_LINEAR = 0x10;
+
+Options parseOptions(int argc, char **argv) {
+    if (argc < 3) {
+        throw std::runtime_error("usage: texture_cooker <input> <output.ktx2> [--format bc1|bc3|bc5|bc7|rgba8] "
+                                 "[--linear] [--no-mips]");
+    }
+
+    Options options;
+    options.inputPath = argv[1];
+    options.outputPath = argv[2];
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            std::string format = argv[++i];
+            if (format == "bc1") {
+                options.format = Format::BC1;
+            } else if (format == "bc3") {
+                options.format = Format::BC3;
+            } else if (format == "bc5") {
+                options.format = Format::BC5;
+            } else if (format == "bc7") {
+                options.format = Format::BC7;
+            } else if (format == "rgba8") {
+                options.format = Format::RGBA8;
+            } else {
+                throw std::runtime_error("unknown format: " + format);
+            }
+        } else if (arg == "--linear") {
+            options.srgb = false;
+        } else if (arg == "--no-mips") {
+            options.mips = false;
+        } else {
+            throw std::runtime_error("unknown argument: " + arg);
+        }
+    }
+
+    // two channel normal/data maps are never colour
+    if (options.format == Format::BC5) {
+        options.srgb = false;
+    }
+    return options;
+}
+
+uint32_t vkFormatFor(const Options &options) {
+    switch (options.format) {
+    case Format::BC1:
+        return options.srgb ? util::KTX2_FORMAT_BC1_RGBA_SRGB : util::KTX2_FORMAT_BC1_RGBA_UNORM;
+    case Format::BC3:
+        return options.srgb ? util::KTX2_FORMAT_BC3_SRGB : util::KTX2_FORMAT_BC3_UNORM;
+    case Format::BC5:
+        return util::KTX2_FORMAT_BC5_UNORM;
+    case Format::BC7:
+        return options.srgb ? util::KTX2_FORMAT_BC7_SRGB : util::KTX2_FORMAT_BC7_UNORM;
+    default:
+        return options.srgb ? util::KTX2_FORMAT_R8G8B8A8_SRGB : util::KTX2_FORMAT_R8G8B8A8_UNORM;
+    }
+}
+
+float srgbToLinear(float value) {
+    value /= 255.0f;
+    return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+}
+
+uint8_t linearToSrgb(float value) {
+    value = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+    return static_cast<uint8_t>(std::clamp(std::lround(value * 255.0f), 0L, 255L));
+}
+
+// 2x2 box filter, done in linear space for colour data
+MipLevel downsample(const MipLevel &source, bool srgb) {
+    static float srgbTable[256];
+    static bool tableReady = false;
+    if (!tableReady) {
+        for (int i = 0; i < 256; i++) {
+            srgbTable[i] = srgbToLinear(static_cast<float>(i));
+        }
+        tableReady = true;
+    }
+
+    MipLevel level;
+    level.width = std::max(1u, source.width / 2);
+    level.height = std::max(1u, source.height / 2);
+    level.rgba.resize(static_cast<size_t>(level.width) * level.height * 4);
+
+    for (uint32_t y = 0; y < level.height; y++) {
+        for (uint32_t x = 0; x < level.width; x++) {
+            float sum[4] = {};
+            for (uint32_t dy = 0; dy < 2; dy++) {
+                for (uint32_t dx = 0; dx < 2; dx++) {
+                    uint32_t sx = std::min(x * 2 + dx, source.width - 1);
+                    uint32_t sy = std::min(y * 2 + dy, source.height - 1);
+                    const uint8_t *texel = &source.rgba[(static_cast<size_t>(sy) * source.width + sx) * 4];
+                    for (int c = 0; c < 4; c++) {
+                        sum[c] += (srgb && c < 3) ? srgbTable[texel[c]] : texel[c];
+                    }
+                }
+            }
+
+            uint8_t *out = &level.rgba[(static_cast<size_t>(y) * level.width + x) * 4];
+            for (int c = 0; c < 4; c++) {
+                float average = sum[c] / 4.0f;
+                out[c] = (srgb && c < 3) ? linearToSrgb(average)
+                                         : static_cast<uint8_t>(std::clamp(std::lround(average), 0L, 255L));
+            }
+        }
+    }
+    return level;
+}
+
+std::vector<uint8_t> encodeLevel(const MipLevel &level, Format format) {
+    if (format == Format::RGBA8) {
+        return level.rgba;
+    }
+
+    uint32_t blocksX = (level.width + 3) / 4;
+    uint32_t blocksY = (level.height + 3) / 4;
+    uint32_t blockSize = format == Format::BC1 ? 8 : 16;
+    std::vector<uint8_t> encoded(static_cast<size_t>(blocksX) * blocksY * blockSize);
+
+    uint8_t block[64];
+    for (uint32_t by = 0; by < blocksY; by++) {
+        for (uint32_t bx = 0; bx < blocksX; bx++) {
+            // edge texels are replicated into partial blocks
+            for (uint32_t y = 0; y < 4; y++) {
+                for (uint32_t x = 0; x < 4; x++) {
+                    uint32_t sx = std::min(bx * 4 + x, level.width - 1);
+                    uint32_t sy = std::min(by * 4 + y, level.height - 1);
+                    std::memcpy(&block[(y * 4 + x) * 4], &level.rgba[(static_cast<size_t>(sy) * level.width + sx) * 4], 4);
+                }
+            }
+
+            uint8_t *out = &encoded[(static_cast<size_t>(by) * blocksX + bx) * blockSize];
+            switch (format) {
+            case Format::BC1:
+                encodeBC1(block, out);
+                break;
+            case Format::BC3:
+                encodeBC3(block, out);
+                break;
+            case Format::BC5:
+                encodeBC5(block, out);
+                break;
+            default:
+                encodeBC7(block, out);
+                break;
+            }
+        }
+    }
+    return encoded;
+}
+
+void pushSample(std::vector<uint32_t> &dfd, uint32_t bitOffset, uint32_t bitLength, uint32_t channel, uint32_t upper) {
+    dfd.push_back(bitOffset | ((bitLength - 1) << 16) | (channel << 24));
+    dfd.push_back(0);
+    dfd.push_back(0);
+    dfd.push_back(upper);
+}
+
+// basic data format descriptor block describing the texel layout
+std::vector<uint32_t> buildDfd(const Options &options, bool hasAlpha) {
+    uint32_t model = KHR_DF_MODEL_RGBSDA;
+    uint32_t blockDimension = 0;
+    uint32_t bytesPlane0 = 4;
+    std::vector<uint32_t> samples;
+
+    switch (options.format) {
+    case Format::BC1:
+        model = KHR_DF_MODEL_BC1A;
+        blockDimension = 3 | (3 << 8);
+        bytesPlane0 = 8;
+        pushSample(samples, 0, 64, hasAlpha ? 1 : 0, UINT32_MAX);
+        break;
+    case Format::BC3:
+        model = KHR_DF_MODEL_BC3;
+        blockDimension = 3 | (3 << 8);
+        bytesPlane0 = 16;
+        pushSample(samples, 0, 64, 15 | KHR_DF_SAMPLE_DATATYPE_LINEAR, UINT32_MAX);
+        pushSample(samples, 64, 64, 0, UINT32_MAX);
+        break;
+    case Format::BC5:
+        model = KHR_DF_MODEL_BC5;
+        blockDimension = 3 | (3 << 8);
+        bytesPlane0 = 16;
+        pushSample(samples, 0, 64, 0, UINT32_MAX);
+        pushSample(samples, 64, 64, 1, UINT32_MAX);
+        break;
+    case Format::BC7:
+        model = KHR_DF_MODEL_BC7;
+        blockDimension = 3 | (3 << 8);
+        bytesPlane0 = 16;
+        pushSample(samples, 0, 128, 0, UINT32_MAX);
+        break;
+    case Format::RGBA8:
+        pushSample(samples, 0, 8, 0, 255);
+        pushSample(samples, 8, 8, 1, 255);
+        pushSample(samples, 16, 8, 2, 255);
+        pushSample(samples, 24, 8, 15 | (options.srgb ? KHR_DF_SAMPLE_DATATYPE_LINEAR : 0), 255);
+        break;
+    }
+
+    uint32_t blockSize = 24 + static_cast<uint32_t>(samples.size()) * 4;
+    uint32_t transfer = options.srgb ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+
+    std::vector<uint32_t> dfd;
+    dfd.push_back(4 + blockSize);
+    dfd.push_back(0);
+    dfd.push_back(2 | (blockSize << 16));
+    dfd.push_back(model | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16));
+    dfd.push_back(blockDimension);
+    dfd.push_back(bytesPlane0);
+    dfd.push_back(0);
+    dfd.insert(dfd.end(), samples.begin(), samples.end());
+    return dfd;
+}
+
+void writeKtx2(const Options &options, const std::vector<std::vector<uint8_t>> &levels, uint32_t width, uint32_t height,
+               bool hasAlpha) {
+    uint32_t vkFormat = vkFormatFor(options);
+    uint64_t alignment = util::ktx2BlockSize(vkFormat);
+    std::vector<uint32_t> dfd = buildDfd(options, hasAlpha);
+
+    util::Ktx2Header header{};
+    std::memcpy(header.identifier, util::KTX2_IDENTIFIER, sizeof(header.identifier));
+    header.vkFormat = vkFormat;
+    header.typeSize = 1;
+    header.pixelWidth = width;
+    header.pixelHeight = height;
+    header.faceCount = 1;
+    header.levelCount = static_cast<uint32_t>(levels.size());
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(util::Ktx2Header) + sizeof(util::Ktx2LevelIndex) * levels.size());
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size() * sizeof(uint32_t));
+
+    // levels are stored smallest first, each aligned to the texel block size
+    std::vector<util::Ktx2LevelIndex> levelIndex(levels.size());
+    uint64_t offset = header.dfdByteOffset + header.dfdByteLength;
+    for (size_t i = levels.size(); i-- > 0;) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        levelIndex[i].byteOffset = offset;
+        levelIndex[i].byteLength = levels[i].size();
+        levelIndex[i].uncompressedByteLength = levels[i].size();
+        offset += levels[i].size();
+    }
+
+    std::vector<uint8_t> file(offset, 0);
+    std::memcpy(file.data(), &header, sizeof(header));
+    std::memcpy(file.data() + sizeof(header), levelIndex.data(), sizeof(util::Ktx2LevelIndex) * levelIndex.size());
+    std::memcpy(file.data() + header.dfdByteOffset, dfd.data(), header.dfdByteLength);
+    for (size_t i = 0; i < levels.size(); i++) {
+        std::memcpy(file.data() + levelIndex[i].byteOffset, levels[i].data(), levels[i].size());
+    }
+
+    std::ofstream out{options.outputPath, std::ios::binary};
+    if (!out.is_open()) {
+        throw std::runtime_error("failed to open output file: " + options.outputPath);
+    }
+    out.write(reinterpret_cast<const char *>(file.data()), static_cast<std::streamsize>(file.size()));
+}
+
+void cook(const Options &options) {
+    int width, height, channels;
+    stbi_uc *pixels = stbi_load(options.inputPath.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        throw std::runtime_error("failed to load image: " + options.inputPath);
+    }
+
+    std::vector<MipLevel> mips(1);
+    mips[0].width = static_cast<uint32_t>(width);
+    mips[0].height = static_cast<uint32_t>(height);
+    mips[0].rgba.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    bool hasAlpha = false;
+    for (size_t i = 3; i < mips[0].rgba.size(); i += 4) {
+        hasAlpha |= mips[0].rgba[i] < 255;
+    }
+
+    while (options.mips && (mips.back().width > 1 || mips.back().height > 1)) {
+        mips.push_back(downsample(mips.back(), options.srgb));
+    }
+
+    std::vector<std::vector<uint8_t>> levels;
+    size_t totalSize = 0;
+    for (const MipLevel &mip : mips) {
+        levels.push_back(encodeLevel(mip, options.format));
+        totalSize += levels.back().size();
+    }
+
+    writeKtx2(options, levels, mips[0].width, mips[0].height, hasAlpha);
+    std::cout << options.inputPath << " -> " << options.outputPath << " (" << width << "x" << height << ", " << levels.size()
+              << " mips, " << totalSize << " bytes)" << std::endl;
+}
+} // namespace
+} // namespace cooker
+
+int main(int argc, char **argv) {
+    try {
+        cooker::cook(cooker::parseOptions(argc, argv));
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}